@@ -0,0 +1,177 @@
+// Walk speed of a list whose nodes are scattered over a churned pool, before and after
+// List_compact. The churn is simulated the way bench_list's fragmented pool is: the
+// pool's free slots are shuffled before the list is built, which is where long runs of
+// random inserts and removes leave them. Also times a compaction done in slices of
+// SLICE_NODES nodes with ListCompactor_step, to show how long one slice takes, and
+// the walk after it. The pool is left with little free room, so both compactions
+// mostly swap the list's own nodes into place. Prints one CSV row per size.
+//
+// Then, after a blank line, a second CSV: how long a STEP_NODES-node step over a
+// STEP_LIST-node list takes with ever more of its arena's pool free. A step takes only up
+// to twice its node count of free slots, so its time should stay flat.
+//
+// Usage: ./bench_compact [maxSize]
+
+#include "list.h"
+#include "list_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Rough number of nodes visited per walk measurement
+#define TARGET_NODES 20000000
+
+// Nodes per ListCompactor_step in the sliced compaction
+#define SLICE_NODES 4096
+
+// List size and nodes per step for the step time against free slots
+#define STEP_LIST 2000
+#define STEP_NODES 64
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Puts count free node indices back into the pool in random order, so the next
+// count allocations land scattered across the pool
+static void scramblePool(int count) {
+    int* indices = malloc(count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        indices[i] = listAllocNodeIndex();
+    }
+    for (int i = count - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = tmp;
+    }
+    for (int i = 0; i < count; i++) {
+        listFreeNodeIndex(indices[i]);
+    }
+    free(indices);
+}
+
+static List* buildChurned(long* values, int size) {
+    scramblePool(size);
+    List* pList = List_create();
+    for (int i = 0; i < size; i++) {
+        List_append(pList, &values[i]);
+    }
+    return pList;
+}
+
+// Nanoseconds per node of a List_first/List_next walk that sums the items
+static double timeWalk(List* pList, int size) {
+    int rounds = 1 + TARGET_NODES / size;
+    long sum = 0;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (long* item = List_first(pList); item != NULL; item = List_next(pList)) {
+            sum += *item;
+        }
+    }
+    double seconds = now() - start;
+    if (sum != (long)rounds * size * (size - 1) / 2) {
+        abort();
+    }
+    return seconds * 1e9 / ((double)rounds * size);
+}
+
+int main(int argc, char** argv) {
+    int maxSize = argc > 1 ? atoi(argv[1]) : 1000000;
+    srand(1);
+    listNodePool(); // Sets the pool up before scramblePool takes indices from it
+
+    printf("size,walk_churned_ns_per_node,compact_ns_per_node,walk_compacted_ns_per_node,"
+        "sliced_compact_ns_per_node,max_slice_us,walk_sliced_ns_per_node\n");
+    for (int size = 1000; size <= maxSize; size *= 10) {
+        long* values = malloc(size * sizeof(long));
+        for (int i = 0; i < size; i++) {
+            values[i] = i;
+        }
+
+        List* pList = buildChurned(values, size);
+        double churned = timeWalk(pList, size);
+        double start = now();
+        if (List_compact(pList) != LIST_SUCCESS) {
+            abort();
+        }
+        double compact = (now() - start) * 1e9 / size;
+        double compacted = timeWalk(pList, size);
+        List_free(pList, NULL);
+
+        pList = buildChurned(values, size);
+        ListCompactor compactor;
+        ListCompactor_init(&compactor, pList);
+        double total = 0;
+        double maxSlice = 0;
+        int result;
+        do {
+            start = now();
+            result = ListCompactor_step(&compactor, SLICE_NODES);
+            double slice = now() - start;
+            total += slice;
+            if (slice > maxSlice) {
+                maxSlice = slice;
+            }
+        } while (result == 1);
+        if (result != 0) {
+            abort();
+        }
+        double sliced = timeWalk(pList, size);
+        List_free(pList, NULL);
+
+        printf("%d,%.3f,%.3f,%.3f,%.3f,%.1f,%.3f\n", size, churned, compact, compacted,
+            total * 1e9 / size, maxSlice * 1e6, sliced);
+        fflush(stdout);
+        free(values);
+    }
+
+    printf("\nfree_slots,steps,mean_step_us,max_step_us\n");
+    long* values = malloc(STEP_LIST * sizeof(long));
+    for (int i = 0; i < STEP_LIST; i++) {
+        values[i] = i;
+    }
+    for (int numFree = 1000; numFree <= 4 * maxSize; numFree *= 10) {
+        // The list's nodes are spread out among numFree others, which are then freed
+        ListArena* arena = ListArena_create();
+        List* pList = List_create_in(arena);
+        List* filler = List_create_in(arena);
+        for (int i = 0; i < numFree; i++) {
+            List_append(filler, &values[0]);
+            if (i % (numFree / STEP_LIST + 1) == 0 && List_count(pList) < STEP_LIST) {
+                List_append(pList, &values[List_count(pList)]);
+            }
+        }
+        while (List_count(pList) < STEP_LIST) {
+            List_append(pList, &values[List_count(pList)]);
+        }
+        List_free(filler, NULL);
+        ListCompactor compactor;
+        ListCompactor_init(&compactor, pList);
+        double total = 0;
+        double maxStep = 0;
+        int steps = 0;
+        int result;
+        do {
+            double start = now();
+            result = ListCompactor_step(&compactor, STEP_NODES);
+            double step = now() - start;
+            total += step;
+            steps++;
+            if (step > maxStep) {
+                maxStep = step;
+            }
+        } while (result == 1);
+        if (result != 0) {
+            abort();
+        }
+        ListArena_destroy(arena);
+        printf("%d,%d,%.2f,%.2f\n", numFree, steps, total * 1e6 / steps, maxStep * 1e6);
+        fflush(stdout);
+    }
+    free(values);
+    return 0;
+}
@@ -0,0 +1,813 @@
+// Microbenchmarks for every List operation.
+// Prints one CSV row (or JSON object) per measurement; build with
+// -DLIST_COMPACT_LINKS to measure the 16-byte node layout (make bench_list_compact).
+//
+// Each benchmark runs over a sweep of list sizes and two pool states:
+//   fresh       nodes are handed out in pool order
+//   fragmented  the pool's free stack is shuffled before every list is built,
+//               so consecutive nodes land scattered across the pool
+//
+// What one op is, for the ns_per_op and mops_per_sec columns:
+//   create                          one List_create of an empty list
+//   append, prepend,
+//   insert_after, insert_before     one insert
+//   remove, trim                    one removal
+//   concat                          one List_concat of a one-item list
+//   next_walk, prev_walk            one step
+//   search_hit, search_miss         one node compared (hits are at the middle)
+//   search_miss_scattered           one node compared, with the items themselves in
+//                                   random order in memory, so each item is a miss too
+//   search_miss_batch               one node compared by List_search_batch
+//   search_miss_typed               one node compared by a LIST_DEFINE list of longs,
+//                                   with the comparison inlined and the items in the nodes
+//   find_key                        one List_find_key on an indexed list
+//   lru_get_hit, lru_scan_hit       one cache hit that moves the item to the front: a
+//                                   ListLru_get, or the hand-rolled List_search,
+//                                   List_remove and List_prepend
+//   free                            one List_free with no FREE_FN (whole list)
+//   free_fn                         one node released by List_free with a FREE_FN
+//   free_each, arena_reset          one 8-item list released, by List_free on each
+//                                   list or by one ListArena_reset for all of them
+//   items_malloc, items_inline      one 16-byte item appended, visited and freed, either
+//                                   malloc'd and referenced or copied into its node
+//   snapshot_save, snapshot_load,   one inline 16-byte item written by List_save, read back
+//   rebuild_append                  by List_load_in, or re-added with List_append_copy
+//
+// The unrolled layout rows are UList, and the ring layout rows are ListDeque (append,
+// remove from the front, next_walk and search_miss, while it is still an array). The intrusive rows are IList over records in
+// random memory order; they are listed under the fragmented pool, to compare with
+// search_miss_scattered there, where both the nodes and the items are scattered.
+//
+// Usage: ./bench_list [--json] [--no-header] [maxSize]
+
+#include "list.h"
+#include "list_typed.h"
+#include "deque.h"
+#include "ilist.h"
+#include "lru.h"
+#include "list_internal.h"
+#include "ulist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef LIST_COMPACT_LINKS
+static const char* layoutName = "compact";
+#else
+static const char* layoutName = "pointer";
+#endif
+
+// Rough number of ops timed per measurement
+#define TARGET_OPS 4000000
+
+static bool jsonOutput = false;
+static bool firstRow = true;
+static const char* poolName = "fresh";
+static bool fragmented = false;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void noopFree(void* pItem) {
+    (void)pItem;
+}
+
+static bool compareLongs(void* pItem, void* pComparisonArg) {
+    return *(long*)pItem == *(long*)pComparisonArg;
+}
+
+static int findLongInBatch(void** pItems, int count, void* pComparisonArg) {
+    long key = *(long*)pComparisonArg;
+    for (int i = 0; i < count; i++) {
+        if (*(long*)pItems[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static size_t hashLong(void* pItem) {
+    return (size_t)*(long*)pItem;
+}
+
+static void report(const char* benchmark, const char* layout, const char* pool, int size, double seconds, long ops) {
+    double nsPerOp = seconds * 1e9 / ops;
+    double mops = ops / seconds / 1e6;
+    if (jsonOutput) {
+        printf("%s  {\"benchmark\": \"%s\", \"layout\": \"%s\", \"pool\": \"%s\", \"size\": %d, "
+            "\"ns_per_op\": %.3f, \"mops_per_sec\": %.3f}",
+            firstRow ? "" : ",\n", benchmark, layout, pool, size, nsPerOp, mops);
+    }
+    else {
+        printf("%s,%s,%s,%d,%.3f,%.3f\n", benchmark, layout, pool, size, nsPerOp, mops);
+    }
+    firstRow = false;
+    fflush(stdout);
+}
+
+static int roundsFor(int opsPerRound) {
+    return 1 + TARGET_OPS / opsPerRound;
+}
+
+// Puts count free node indices back into the pool in random order, so the next
+// count allocations land scattered across the pool instead of in address order
+static void scramblePool(int count) {
+    int* indices = malloc(count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        indices[i] = listAllocNodeIndex();
+    }
+    for (int i = count - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = tmp;
+    }
+    for (int i = 0; i < count; i++) {
+        listFreeNodeIndex(indices[i]);
+    }
+    free(indices);
+}
+
+// Readies the pool for the next count node allocations
+static void preparePool(int count) {
+    if (fragmented) {
+        scramblePool(count);
+    }
+}
+
+static List* buildList(long* values, int size) {
+    preparePool(size);
+    List* pList = List_create();
+    for (int i = 0; i < size; i++) {
+        List_append(pList, &values[i]);
+    }
+    return pList;
+}
+
+static void benchCreate(int size) {
+    int rounds = roundsFor(size);
+    List** lists = malloc(size * sizeof(List*));
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        double start = now();
+        for (int i = 0; i < size; i++) {
+            lists[i] = List_create();
+        }
+        seconds += now() - start;
+        for (int i = 0; i < size; i++) {
+            List_free(lists[i], NULL);
+        }
+    }
+    free(lists);
+    report("create", layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+enum { BUILD_APPEND, BUILD_PREPEND, BUILD_INSERT_AFTER, BUILD_INSERT_BEFORE };
+
+static void benchBuild(const char* benchmark, int how, long* values, int size) {
+    int rounds = roundsFor(size);
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        preparePool(size);
+        List* pList = List_create();
+        double start = now();
+        switch (how) {
+        case BUILD_APPEND:
+            for (int i = 0; i < size; i++) {
+                List_append(pList, &values[i]);
+            }
+            break;
+        case BUILD_PREPEND:
+            for (int i = 0; i < size; i++) {
+                List_prepend(pList, &values[i]);
+            }
+            break;
+        case BUILD_INSERT_AFTER:
+            for (int i = 0; i < size; i++) {
+                List_insert_after(pList, &values[i]);
+            }
+            break;
+        default:
+            for (int i = 0; i < size; i++) {
+                List_insert_before(pList, &values[i]);
+            }
+            break;
+        }
+        seconds += now() - start;
+        List_free(pList, NULL);
+    }
+    report(benchmark, layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+static void benchRemove(long* values, int size) {
+    int rounds = roundsFor(size);
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        List* pList = buildList(values, size);
+        List_first(pList);
+        double start = now();
+        for (int i = 0; i < size; i++) {
+            List_remove(pList);
+        }
+        seconds += now() - start;
+        List_free(pList, NULL);
+    }
+    report("remove", layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+static void benchTrim(long* values, int size) {
+    int rounds = roundsFor(size);
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        List* pList = buildList(values, size);
+        double start = now();
+        for (int i = 0; i < size; i++) {
+            List_trim(pList);
+        }
+        seconds += now() - start;
+        List_free(pList, NULL);
+    }
+    report("trim", layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+static void benchConcat(long* values, int size) {
+    int rounds = roundsFor(size);
+    List** lists = malloc(size * sizeof(List*));
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        preparePool(size);
+        for (int i = 0; i < size; i++) {
+            lists[i] = List_create();
+            List_append(lists[i], &values[i]);
+        }
+        double start = now();
+        for (int i = 1; i < size; i++) {
+            List_concat(lists[0], lists[i]);
+        }
+        seconds += now() - start;
+        List_free(lists[0], NULL);
+    }
+    free(lists);
+    report("concat", layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+static void benchWalks(List* pList, int size) {
+    int rounds = roundsFor(size);
+    long sum = 0;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (long* item = List_first(pList); item != NULL; item = List_next(pList)) {
+            sum += *item;
+        }
+    }
+    double seconds = now() - start;
+    report("next_walk", layoutName, poolName, size, seconds, (long)rounds * size);
+
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (long* item = List_last(pList); item != NULL; item = List_prev(pList)) {
+            sum += *item;
+        }
+    }
+    seconds = now() - start;
+    report("prev_walk", layoutName, poolName, size, seconds, (long)rounds * size);
+    if (sum == 42) {
+        printf("#\n"); // Keeps the loops from being optimized away
+    }
+}
+
+static void benchSearches(List* pList, long* values, int size) {
+    int rounds = roundsFor(size);
+    long target = values[size / 2];
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        List_first(pList);
+        if (List_search(pList, compareLongs, &target) == NULL) {
+            abort();
+        }
+    }
+    double seconds = now() - start;
+    report("search_hit", layoutName, poolName, size, seconds, (long)rounds * (size / 2 + 1));
+
+    long missing = -1;
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        List_first(pList);
+        if (List_search(pList, compareLongs, &missing) != NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("search_miss", layoutName, poolName, size, seconds, (long)rounds * size);
+
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        List_first(pList);
+        if (List_search_batch(pList, findLongInBatch, &missing) != NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("search_miss_batch", layoutName, poolName, size, seconds, (long)rounds * size);
+
+    if (List_enable_index(pList, hashLong, compareLongs) != 0) {
+        abort();
+    }
+    long lookups = TARGET_OPS;
+    start = now();
+    for (long i = 0; i < lookups; i++) {
+        long key = (i * 7919) % size;
+        if (List_find_key(pList, &key) == NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("find_key", layoutName, poolName, size, seconds, lookups);
+    List_disable_index(pList);
+}
+
+static void benchSearchScattered(long* values, int size) {
+    // Point the list at the values in a random order
+    long** items = malloc(size * sizeof(long*));
+    for (int i = 0; i < size; i++) {
+        items[i] = &values[i];
+    }
+    for (int i = size - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        long* tmp = items[i];
+        items[i] = items[j];
+        items[j] = tmp;
+    }
+    preparePool(size);
+    List* pList = List_create();
+    for (int i = 0; i < size; i++) {
+        List_append(pList, items[i]);
+    }
+
+    int rounds = roundsFor(size);
+    long missing = -1;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        List_first(pList);
+        if (List_search(pList, compareLongs, &missing) != NULL) {
+            abort();
+        }
+    }
+    double seconds = now() - start;
+    report("search_miss_scattered", layoutName, poolName, size, seconds, (long)rounds * size);
+    List_free(pList, NULL);
+    free(items);
+}
+
+static void benchFree(long* values, int size) {
+    int rounds = roundsFor(size);
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        List* pList = buildList(values, size);
+        double start = now();
+        List_free(pList, NULL);
+        seconds += now() - start;
+    }
+    report("free", layoutName, poolName, size, seconds, rounds);
+
+    seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        List* pList = buildList(values, size);
+        double start = now();
+        List_free(pList, noopFree);
+        seconds += now() - start;
+    }
+    report("free_fn", layoutName, poolName, size, seconds, (long)rounds * size);
+}
+
+// Builds size / 8 lists of 8 items and times releasing them one by one, then
+// the same lists built in an arena and released by resetting it
+static void benchArenaReset(long* values, int size) {
+    enum { ITEMS_PER_LIST = 8 };
+    int numLists = size / ITEMS_PER_LIST;
+    if (numLists == 0) {
+        return;
+    }
+    int rounds = roundsFor(numLists);
+    List** lists = malloc(numLists * sizeof(List*));
+    ListArena* arena = ListArena_create();
+    void* items[ITEMS_PER_LIST];
+    for (int i = 0; i < ITEMS_PER_LIST; i++) {
+        items[i] = &values[i];
+    }
+
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < numLists; i++) {
+            lists[i] = List_create();
+            List_append_n(lists[i], items, ITEMS_PER_LIST);
+        }
+        double start = now();
+        for (int i = 0; i < numLists; i++) {
+            List_free(lists[i], NULL);
+        }
+        seconds += now() - start;
+    }
+    report("free_each", layoutName, poolName, size, seconds, (long)rounds * numLists);
+
+    seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < numLists; i++) {
+            lists[i] = List_create_in(arena);
+            List_append_n(lists[i], items, ITEMS_PER_LIST);
+        }
+        double start = now();
+        ListArena_reset(arena);
+        seconds += now() - start;
+    }
+    report("arena_reset", layoutName, poolName, size, seconds, (long)rounds * numLists);
+
+    ListArena_destroy(arena);
+    free(lists);
+}
+
+typedef struct BenchSample_s BenchSample;
+struct BenchSample_s {
+    long id;
+    long timestamp;
+};
+
+// Times cache hits at random keys through ListLru against a search, remove and prepend
+static void benchLru(long* values, int size) {
+    ListLru* pLru = ListLru_create(size, hashLong, compareLongs, NULL, NULL);
+    List* pList = List_create();
+    for (int i = 0; i < size; i++) {
+        ListLru_put(pLru, &values[i]);
+        List_prepend(pList, &values[i]);
+    }
+
+    long lookups = TARGET_OPS;
+    double start = now();
+    for (long i = 0; i < lookups; i++) {
+        long key = (i * 7919) % size;
+        if (ListLru_get(pLru, &key) == NULL) {
+            abort();
+        }
+    }
+    report("lru_get_hit", layoutName, poolName, size, now() - start, lookups);
+
+    // Each scan averages half the list, so run fewer of them
+    lookups = 1 + TARGET_OPS / size;
+    start = now();
+    for (long i = 0; i < lookups; i++) {
+        long key = (i * 7919) % size;
+        List_first(pList);
+        void* pItem = List_search(pList, compareLongs, &key);
+        if (pItem == NULL) {
+            abort();
+        }
+        List_remove(pList);
+        List_prepend(pList, pItem);
+    }
+    report("lru_scan_hit", layoutName, poolName, size, now() - start, lookups);
+
+    ListLru_free(pLru, NULL);
+    List_free(pList, NULL);
+}
+
+#define LONGS_EQUAL(item, key) (*(item) == *(key))
+LIST_DEFINE(LongList, long, LONGS_EQUAL)
+
+// Times missed searches of a typed list, to set against search_miss
+static void benchTypedSearch(long* values, int size) {
+    LongList* longs = LongList_create();
+    if (longs == NULL) {
+        return; // Not available with compact links
+    }
+    for (int i = 0; i < size; i++) {
+        LongList_append(longs, values[i]);
+    }
+    int rounds = roundsFor(size);
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        LongList_first(longs);
+        if (LongList_search(longs, -1) != NULL) {
+            abort();
+        }
+    }
+    report("search_miss_typed", layoutName, poolName, size, now() - start, (long)rounds * size);
+    LongList_free(longs);
+}
+
+// Builds, walks and frees a list of small items, first malloc'ing each item, then
+// copying them into the nodes of an inline arena
+static void benchInlineItems(int size) {
+    ListArena* arena = ListArena_create_inline(sizeof(BenchSample));
+    if (arena == NULL) {
+        return; // Not available with compact links
+    }
+    int rounds = roundsFor(size);
+    long sum = 0;
+
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        List* pList = List_create_in(arena);
+        for (int i = 0; i < size; i++) {
+            BenchSample* sample = malloc(sizeof(BenchSample));
+            *sample = (BenchSample){ i, r };
+            List_append(pList, sample);
+        }
+        for (BenchSample* sample = List_first(pList); sample != NULL; sample = List_next(pList)) {
+            sum += sample->id;
+        }
+        List_free(pList, free);
+    }
+    report("items_malloc", layoutName, poolName, size, now() - start, (long)rounds * size);
+
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        List* pList = List_create_in(arena);
+        for (int i = 0; i < size; i++) {
+            BenchSample sample = { i, r };
+            List_append_copy(pList, &sample);
+        }
+        for (BenchSample* sample = List_first(pList); sample != NULL; sample = List_next(pList)) {
+            sum += sample->id;
+        }
+        List_free(pList, free);
+    }
+    report("items_inline", layoutName, poolName, size, now() - start, (long)rounds * size);
+
+    if (sum == 42) {
+        printf("#\n"); // Keeps the loops from being optimized away
+    }
+    ListArena_destroy(arena);
+}
+
+// Times saving a list of inline items and loading it back, against rebuilding it
+// item by item. The snapshot goes to a file in the current directory.
+static void benchSnapshot(int size) {
+    const char* path = "bench_list_snapshot.tmp";
+    ListArena* arena = ListArena_create_inline(sizeof(BenchSample));
+    if (arena == NULL) {
+        return; // Not available with compact links
+    }
+    int rounds = roundsFor(size);
+    List* pList = List_create_in(arena);
+    for (int i = 0; i < size; i++) {
+        BenchSample sample = { i, 0 };
+        List_append_copy(pList, &sample);
+    }
+
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        List_save(pList, path, sizeof(BenchSample), NULL);
+    }
+    report("snapshot_save", layoutName, poolName, size, now() - start, (long)rounds * size);
+    List_free(pList, NULL);
+
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        start = now();
+        pList = List_load_in(arena, path, NULL);
+        seconds += now() - start;
+        List_free(pList, NULL);
+    }
+    report("snapshot_load", layoutName, poolName, size, seconds, (long)rounds * size);
+
+    seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        start = now();
+        pList = List_create_in(arena);
+        for (int i = 0; i < size; i++) {
+            BenchSample sample = { i, 0 };
+            List_append_copy(pList, &sample);
+        }
+        seconds += now() - start;
+        List_free(pList, NULL);
+    }
+    report("rebuild_append", layoutName, poolName, size, seconds, (long)rounds * size);
+
+    remove(path);
+    ListArena_destroy(arena);
+}
+
+typedef struct BenchRecord_s BenchRecord;
+struct BenchRecord_s {
+    long value;
+    IListLink link;
+};
+
+static bool compareRecordLinks(void* pItem, void* pComparisonArg) {
+    return ILIST_ENTRY((IListLink*)pItem, BenchRecord, link)->value == *(long*)pComparisonArg;
+}
+
+static void benchIList(int size) {
+    BenchRecord* records = malloc(size * sizeof(BenchRecord));
+    int* order = malloc(size * sizeof(int));
+    for (int i = 0; i < size; i++) {
+        records[i].value = i;
+        order[i] = i;
+    }
+    for (int i = size - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    IList list;
+    IList_init(&list);
+    for (int i = 0; i < size; i++) {
+        IList_append(&list, &records[order[i]].link);
+    }
+
+    int rounds = roundsFor(size);
+    long sum = 0;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (IListLink* link = IList_first(&list); link != NULL; link = IList_next(&list)) {
+            sum += ILIST_ENTRY(link, BenchRecord, link)->value;
+        }
+    }
+    double seconds = now() - start;
+    if (sum == 42) {
+        printf("#\n");
+    }
+    report("next_walk", "intrusive", poolName, size, seconds, (long)rounds * size);
+
+    long missing = -1;
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        IList_first(&list);
+        if (IList_search(&list, compareRecordLinks, &missing) != NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("search_miss_scattered", "intrusive", poolName, size, seconds, (long)rounds * size);
+    free(order);
+    free(records);
+}
+
+static void benchUList(long* values, int size) {
+    UList* pList = UList_create();
+    for (int i = 0; i < size; i++) {
+        UList_append(pList, &values[i]);
+    }
+
+    int rounds = roundsFor(size);
+    long sum = 0;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (long* item = UList_first(pList); item != NULL; item = UList_next(pList)) {
+            sum += *item;
+        }
+    }
+    double seconds = now() - start;
+    if (sum == 42) {
+        printf("#\n");
+    }
+    report("next_walk", "unrolled", poolName, size, seconds, (long)rounds * size);
+
+    long missing = -1;
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        UList_first(pList);
+        if (UList_search(pList, compareLongs, &missing) != NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("search_miss", "unrolled", poolName, size, seconds, (long)rounds * size);
+    UList_free(pList, NULL);
+}
+
+static void benchDeque(long* values, int size) {
+    int rounds = roundsFor(size);
+    double seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        ListDeque* pDeque = ListDeque_create();
+        double start = now();
+        for (int i = 0; i < size; i++) {
+            ListDeque_append(pDeque, &values[i]);
+        }
+        seconds += now() - start;
+        ListDeque_free(pDeque, NULL);
+    }
+    report("append", "ring", poolName, size, seconds, (long)rounds * size);
+
+    seconds = 0;
+    for (int r = 0; r < rounds; r++) {
+        ListDeque* pDeque = ListDeque_create();
+        for (int i = 0; i < size; i++) {
+            ListDeque_append(pDeque, &values[i]);
+        }
+        ListDeque_first(pDeque);
+        double start = now();
+        for (int i = 0; i < size; i++) {
+            ListDeque_remove(pDeque);
+        }
+        seconds += now() - start;
+        ListDeque_free(pDeque, NULL);
+    }
+    report("remove", "ring", poolName, size, seconds, (long)rounds * size);
+
+    ListDeque* pDeque = ListDeque_create();
+    for (int i = 0; i < size; i++) {
+        ListDeque_append(pDeque, &values[i]);
+    }
+    long sum = 0;
+    double start = now();
+    for (int r = 0; r < rounds; r++) {
+        for (long* item = ListDeque_first(pDeque); item != NULL; item = ListDeque_next(pDeque)) {
+            sum += *item;
+        }
+    }
+    seconds = now() - start;
+    if (sum == 42) {
+        printf("#\n");
+    }
+    report("next_walk", "ring", poolName, size, seconds, (long)rounds * size);
+
+    long missing = -1;
+    start = now();
+    for (int r = 0; r < rounds; r++) {
+        ListDeque_first(pDeque);
+        if (ListDeque_search(pDeque, compareLongs, &missing) != NULL) {
+            abort();
+        }
+    }
+    seconds = now() - start;
+    report("search_miss", "ring", poolName, size, seconds, (long)rounds * size);
+    ListDeque_free(pDeque, NULL);
+}
+
+int main(int argc, char** argv) {
+    int maxSize = 1000000;
+    bool header = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            jsonOutput = true;
+        }
+        else if (strcmp(argv[i], "--no-header") == 0) {
+            header = false;
+        }
+        else {
+            maxSize = atoi(argv[i]);
+        }
+    }
+    srand(1);
+
+    if (jsonOutput) {
+        printf("[\n");
+    }
+    else if (header) {
+        printf("benchmark,layout,pool,size,ns_per_op,mops_per_sec\n");
+    }
+
+    // Every fresh run comes first, before anything has shuffled the pool
+    for (int pass = 0; pass <= 1; pass++) {
+        fragmented = pass == 1;
+        poolName = fragmented ? "fragmented" : "fresh";
+        for (int size = 100; size <= maxSize; size *= 10) {
+            long* values = malloc(size * sizeof(long));
+            for (int i = 0; i < size; i++) {
+                values[i] = i;
+            }
+
+            benchCreate(size);
+            benchBuild("append", BUILD_APPEND, values, size);
+            benchBuild("prepend", BUILD_PREPEND, values, size);
+            benchBuild("insert_after", BUILD_INSERT_AFTER, values, size);
+            benchBuild("insert_before", BUILD_INSERT_BEFORE, values, size);
+            benchRemove(values, size);
+            benchTrim(values, size);
+            benchConcat(values, size);
+
+            List* pList = buildList(values, size);
+            benchWalks(pList, size);
+            benchSearches(pList, values, size);
+            List_free(pList, NULL);
+
+            benchSearchScattered(values, size);
+            benchFree(values, size);
+            if (!fragmented) {
+                benchArenaReset(values, size);
+                benchTypedSearch(values, size);
+                benchLru(values, size);
+                benchInlineItems(size);
+                benchSnapshot(size);
+                benchUList(values, size);
+                benchDeque(values, size);
+            }
+            else {
+                benchIList(size);
+            }
+            free(values);
+        }
+    }
+
+    if (jsonOutput) {
+        printf("\n]\n");
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Throughput benchmark for ListQueue against a mutex-protected List used as a queue.
+// Scales producers and consumers from 1 to N and prints one CSV row per run.
+//
+// Usage: ./bench_queue [maxThreads] [itemsPerProducer]
+
+#include "list.h"
+#include "queue.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef enum { IMPL_LOCKFREE, IMPL_MUTEX_LIST } QueueImpl;
+static const char* implNames[] = { "lockfree", "mutex_list" };
+
+static QueueImpl impl;
+static ListQueue* queue;
+static List* mutexList;
+static pthread_mutex_t mutexListLock = PTHREAD_MUTEX_INITIALIZER;
+
+static long itemsPerProducer;
+static atomic_long itemsLeft;
+static pthread_barrier_t startBarrier;
+
+static void enqueue(void* item) {
+    if (impl == IMPL_LOCKFREE) {
+        while (ListQueue_enqueue(queue, item) != LIST_SUCCESS) {
+        }
+        return;
+    }
+    pthread_mutex_lock(&mutexListLock);
+    List_append(mutexList, item);
+    pthread_mutex_unlock(&mutexListLock);
+}
+
+static void* dequeue() {
+    if (impl == IMPL_LOCKFREE) {
+        return ListQueue_dequeue(queue);
+    }
+    pthread_mutex_lock(&mutexListLock);
+    void* item = List_first(mutexList) != NULL ? List_remove(mutexList) : NULL;
+    pthread_mutex_unlock(&mutexListLock);
+    return item;
+}
+
+static void* producer(void* arg) {
+    (void)arg;
+    pthread_barrier_wait(&startBarrier);
+    for (long i = 1; i <= itemsPerProducer; i++) {
+        enqueue((void*)i);
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    (void)arg;
+    pthread_barrier_wait(&startBarrier);
+    while (atomic_load_explicit(&itemsLeft, memory_order_relaxed) > 0) {
+        if (dequeue() != NULL) {
+            atomic_fetch_sub_explicit(&itemsLeft, 1, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+static void noopFree(void* pItem) {
+    (void)pItem;
+}
+
+// Doubles count, but still visits limit itself when it is not a power of two
+static int nextCount(int count, int limit) {
+    return (count < limit && count * 2 > limit) ? limit : count * 2;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void runOnce(QueueImpl which, int numProducers, int numConsumers) {
+    impl = which;
+    atomic_store(&itemsLeft, itemsPerProducer * numProducers);
+    pthread_barrier_init(&startBarrier, NULL, numProducers + numConsumers + 1);
+
+    pthread_t threads[numProducers + numConsumers];
+    for (int i = 0; i < numProducers; i++) {
+        pthread_create(&threads[i], NULL, producer, NULL);
+    }
+    for (int i = 0; i < numConsumers; i++) {
+        pthread_create(&threads[numProducers + i], NULL, consumer, NULL);
+    }
+
+    pthread_barrier_wait(&startBarrier);
+    double start = now();
+    for (int i = 0; i < numProducers + numConsumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double seconds = now() - start;
+    pthread_barrier_destroy(&startBarrier);
+
+    long items = itemsPerProducer * numProducers;
+    printf("%s,%d,%d,%ld,%.6f,%.3f\n", implNames[which], numProducers, numConsumers,
+        items, seconds, items / seconds / 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    itemsPerProducer = argc > 2 ? atol(argv[2]) : 200000;
+    if (maxThreads < 1) {
+        maxThreads = 1;
+    }
+
+    queue = ListQueue_create();
+    mutexList = List_create();
+
+    printf("impl,producers,consumers,items,seconds,mops\n");
+    for (int producers = 1; producers <= maxThreads; producers = nextCount(producers, maxThreads)) {
+        for (int consumers = 1; consumers <= maxThreads; consumers = nextCount(consumers, maxThreads)) {
+            runOnce(IMPL_LOCKFREE, producers, consumers);
+            runOnce(IMPL_MUTEX_LIST, producers, consumers);
+        }
+    }
+
+    ListQueue_free(queue, NULL);
+    List_free(mutexList, noopFree);
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Read throughput of an RCU list against a List guarded by a pthread rwlock, as the
+// number of readers grows. One writer keeps replacing the oldest item with a new one
+// at the end while the readers walk the whole list. Prints one CSV row per run.
+//
+// Usage: ./bench_rcu [maxReaders] [items] [milliseconds]
+
+#include "list.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef enum { IMPL_RCU, IMPL_RWLOCK } ReadImpl;
+static const char* implNames[] = { "rcu", "rwlock" };
+
+static ReadImpl impl;
+static List* list;
+static pthread_rwlock_t listLock = PTHREAD_RWLOCK_INITIALIZER;
+
+static atomic_bool stopping;
+static atomic_long totalWalks;
+static long totalWrites;
+static pthread_barrier_t startBarrier;
+
+static long walkOnce() {
+    long sum = 0;
+    ListIter iter;
+    if (impl == IMPL_RCU) {
+        List_rcu_read_lock();
+    }
+    else {
+        pthread_rwlock_rdlock(&listLock);
+    }
+    for (void* item = ListIter_begin(&iter, list); item != NULL; item = ListIter_next(&iter)) {
+        sum += (intptr_t)item;
+    }
+    if (impl == IMPL_RCU) {
+        List_rcu_read_unlock();
+    }
+    else {
+        pthread_rwlock_unlock(&listLock);
+    }
+    return sum;
+}
+
+static void* reader(void* arg) {
+    (void)arg;
+    pthread_barrier_wait(&startBarrier);
+    long walks = 0;
+    long sum = 0;
+    while (!atomic_load_explicit(&stopping, memory_order_relaxed)) {
+        sum += walkOnce();
+        walks++;
+    }
+    if (sum == 42) printf("#\n"); // Keeps the walks from being optimized away
+    atomic_fetch_add(&totalWalks, walks);
+    return NULL;
+}
+
+// Items are small integers cast to pointers, so nothing needs freeing
+static void* writer(void* arg) {
+    intptr_t nextValue = (intptr_t)arg;
+    pthread_barrier_wait(&startBarrier);
+    long writes = 0;
+    while (!atomic_load_explicit(&stopping, memory_order_relaxed)) {
+        if (impl == IMPL_RWLOCK) {
+            pthread_rwlock_wrlock(&listLock);
+        }
+        List_first(list);
+        List_remove(list);
+        List_append(list, (void*)nextValue++);
+        if (impl == IMPL_RWLOCK) {
+            pthread_rwlock_unlock(&listLock);
+        }
+        writes++;
+    }
+    totalWrites = writes;
+    return NULL;
+}
+
+// Doubles count, but still visits limit itself when it is not a power of two
+static int nextCount(int count, int limit) {
+    return (count < limit && count * 2 > limit) ? limit : count * 2;
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void runOnce(ReadImpl which, int numReaders, int numItems, int milliseconds) {
+    impl = which;
+    list = List_create();
+    if (which == IMPL_RCU) {
+        List_enable_rcu(list);
+    }
+    for (intptr_t i = 1; i <= numItems; i++) {
+        List_append(list, (void*)i);
+    }
+    atomic_store(&stopping, false);
+    atomic_store(&totalWalks, 0);
+    pthread_barrier_init(&startBarrier, NULL, numReaders + 2);
+
+    pthread_t threads[numReaders + 1];
+    pthread_create(&threads[0], NULL, writer, (void*)(intptr_t)(numItems + 1));
+    for (int i = 1; i <= numReaders; i++) {
+        pthread_create(&threads[i], NULL, reader, NULL);
+    }
+
+    pthread_barrier_wait(&startBarrier);
+    double start = now();
+    usleep(milliseconds * 1000);
+    atomic_store(&stopping, true);
+    for (int i = 0; i <= numReaders; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double seconds = now() - start;
+    pthread_barrier_destroy(&startBarrier);
+    List_free(list, NULL);
+
+    long walks = atomic_load(&totalWalks);
+    printf("%s,%d,%d,%ld,%ld,%.6f,%.3f,%.3f\n", implNames[which], numReaders, numItems, walks,
+        totalWrites, seconds, walks / seconds / 1e3, totalWrites / seconds / 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    int maxReaders = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int numItems = argc > 2 ? atoi(argv[2]) : 1000;
+    int milliseconds = argc > 3 ? atoi(argv[3]) : 500;
+    if (maxReaders < 1) {
+        maxReaders = 1;
+    }
+
+    printf("impl,readers,items,walks,writes,seconds,kwalks_per_sec,mwrites_per_sec\n");
+    for (int readers = 1; readers <= maxReaders; readers = nextCount(readers, maxReaders)) {
+        runOnce(IMPL_RCU, readers, numItems, milliseconds);
+        runOnce(IMPL_RWLOCK, readers, numItems, milliseconds);
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// List_sort against the copy-out approach it replaces: copying the items into an array
+// with List_next, qsorting the array and rebuilding the list with List_append. Items are
+// longs in random order with some ties, and each size is sorted from fresh random
+// order several times. Prints one CSV row per size and method.
+//
+// Usage: ./bench_sort [maxSize]
+
+#include "list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Rough number of nodes sorted per measurement
+#define TARGET_NODES 20000000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compareLongs(const void* pItem1, const void* pItem2) {
+    long a = *(const long*)pItem1;
+    long b = *(const long*)pItem2;
+    return (a > b) - (a < b);
+}
+
+// qsort hands over pointers to the array's item pointers
+static int compareLongPointers(const void* p1, const void* p2) {
+    return compareLongs(*(void* const*)p1, *(void* const*)p2);
+}
+
+// Builds a list of the values in a freshly shuffled order
+static List* buildShuffled(long* values, int size) {
+    for (int i = size - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        long tmp = values[i];
+        values[i] = values[j];
+        values[j] = tmp;
+    }
+    List* pList = List_create();
+    for (int i = 0; i < size; i++) {
+        List_append(pList, &values[i]);
+    }
+    return pList;
+}
+
+static void checkSorted(List* pList, int size) {
+    long* previous = NULL;
+    int count = 0;
+    for (long* item = List_first(pList); item != NULL; item = List_next(pList)) {
+        if (previous != NULL && *previous > *item) {
+            abort();
+        }
+        previous = item;
+        count++;
+    }
+    if (count != size) {
+        abort();
+    }
+}
+
+// Sorts by copying the items out, qsorting them and building a new list
+static List* sortByCopying(List* pList, void** items) {
+    int size = 0;
+    for (void* item = List_first(pList); item != NULL; item = List_next(pList)) {
+        items[size++] = item;
+    }
+    qsort(items, size, sizeof(void*), compareLongPointers);
+    List_free(pList, NULL);
+    pList = List_create();
+    for (int i = 0; i < size; i++) {
+        List_append(pList, items[i]);
+    }
+    return pList;
+}
+
+static void report(const char* method, int size, double seconds, int rounds) {
+    printf("%s,%d,%d,%.6f,%.3f\n", method, size, rounds, seconds / rounds,
+        seconds * 1e9 / ((double)rounds * size));
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    int maxSize = argc > 1 ? atoi(argv[1]) : 10000000;
+    srand(1);
+
+    printf("method,size,rounds,seconds_per_sort,ns_per_node\n");
+    for (int size = 1000; size <= maxSize; size *= 10) {
+        long* values = malloc(size * sizeof(long));
+        void** items = malloc(size * sizeof(void*));
+        for (int i = 0; i < size; i++) {
+            values[i] = i / 4; // Every key four times
+        }
+        int rounds = 1 + TARGET_NODES / size;
+
+        double seconds = 0;
+        for (int r = 0; r < rounds; r++) {
+            List* pList = buildShuffled(values, size);
+            double start = now();
+            List_sort(pList, compareLongs);
+            seconds += now() - start;
+            checkSorted(pList, size);
+            List_free(pList, NULL);
+        }
+        report("list_sort", size, seconds, rounds);
+
+        seconds = 0;
+        for (int r = 0; r < rounds; r++) {
+            List* pList = buildShuffled(values, size);
+            double start = now();
+            pList = sortByCopying(pList, items);
+            seconds += now() - start;
+            checkSorted(pList, size);
+            List_free(pList, NULL);
+        }
+        report("copy_qsort_rebuild", size, seconds, rounds);
+
+        free(values);
+        free(items);
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+#include "deque.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slot in the array of the item at position (0 is the first item)
+static inline int slotOf(ListDeque* pDeque, int position) {
+    return (pDeque->start + position) & (pDeque->capacity - 1);
+}
+
+// Grows the array to hold at least count items. Returns 0 on success, -1 on failure.
+static int reserve(ListDeque* pDeque, int count) {
+    if (count <= pDeque->capacity) {
+        return 0;
+    }
+    int capacity = pDeque->capacity > 0 ? pDeque->capacity : LIST_DEQUE_MIN_CAPACITY;
+    while (capacity < count) {
+        if (capacity > INT_MAX / 2) {
+            return -1;
+        }
+        capacity *= 2;
+    }
+    void** items = realloc(pDeque->items, (size_t)capacity * sizeof(void*));
+    if (items == NULL) {
+        return -1;
+    }
+
+    // Items that wrapped round to the front of the old array now follow on after it;
+    // the array at least doubled, so they fit without moving start
+    int wrapped = pDeque->start + pDeque->size - pDeque->capacity;
+    if (wrapped > 0) {
+        memcpy(items + pDeque->capacity, items, (size_t)wrapped * sizeof(void*));
+    }
+    pDeque->items = items;
+    pDeque->capacity = capacity;
+    return 0;
+}
+
+static int pushBack(ListDeque* pDeque, void* pItem) {
+    if (reserve(pDeque, pDeque->size + 1) != 0) {
+        return LIST_FAIL;
+    }
+    pDeque->items[slotOf(pDeque, pDeque->size)] = pItem;
+    pDeque->curr = pDeque->size++;
+    return LIST_SUCCESS;
+}
+
+static int pushFront(ListDeque* pDeque, void* pItem) {
+    if (reserve(pDeque, pDeque->size + 1) != 0) {
+        return LIST_FAIL;
+    }
+    pDeque->start = (pDeque->start - 1) & (pDeque->capacity - 1);
+    pDeque->items[pDeque->start] = pItem;
+    pDeque->size++;
+    pDeque->curr = 0;
+    return LIST_SUCCESS;
+}
+
+// Moves every item into a linked List, keeping the current item and both flags.
+// Returns 0 on success, -1 (with the deque unchanged) on failure.
+static int toLinked(ListDeque* pDeque) {
+    List* pList = List_create();
+    if (pList == NULL) {
+        return LIST_FAIL;
+    }
+
+    // The items are at most two runs: from start to the end of the array, then from its front
+    int firstRun = pDeque->size < pDeque->capacity - pDeque->start ? pDeque->size : pDeque->capacity - pDeque->start;
+    if ((firstRun > 0 && List_append_n(pList, pDeque->items + pDeque->start, firstRun) != LIST_SUCCESS)
+        || (pDeque->size > firstRun && List_append_n(pList, pDeque->items, pDeque->size - firstRun) != LIST_SUCCESS)) {
+        List_free(pList, NULL);
+        return LIST_FAIL;
+    }
+    List_seek(pList, pDeque->curr);
+    pList->oob_start = pDeque->oob_start;
+    pList->oob_end = pDeque->oob_end;
+
+    free(pDeque->items);
+    pDeque->items = NULL;
+    pDeque->capacity = 0;
+    pDeque->start = 0;
+    pDeque->size = 0;
+    pDeque->curr = -1;
+    pDeque->list = pList;
+    return LIST_SUCCESS;
+}
+
+// Makes a new, empty deque, and returns its reference on success.
+ListDeque* ListDeque_create() {
+    ListDeque* pDeque = calloc(1, sizeof(ListDeque));
+    if (pDeque == NULL) {
+        return NULL;
+    }
+    pDeque->curr = -1;
+    return pDeque;
+}
+
+// Returns the number of items in pDeque.
+int ListDeque_count(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_count(pDeque->list);
+    }
+    return pDeque->size;
+}
+
+// Returns a pointer to the first item in pDeque and makes the first item the current item.
+void* ListDeque_first(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_first(pDeque->list);
+    }
+    pDeque->oob_start = false;
+    pDeque->oob_end = false;
+    if (pDeque->size == 0) {
+        pDeque->curr = -1;
+        return NULL;
+    }
+    pDeque->curr = 0;
+    return pDeque->items[pDeque->start];
+}
+
+// Returns a pointer to the last item in pDeque and makes the last item the current item.
+void* ListDeque_last(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_last(pDeque->list);
+    }
+    pDeque->oob_start = false;
+    pDeque->oob_end = false;
+    pDeque->curr = pDeque->size - 1;
+    if (pDeque->size == 0) {
+        return NULL;
+    }
+    return pDeque->items[slotOf(pDeque, pDeque->curr)];
+}
+
+// Advances pDeque's current item by one, and returns a pointer to the new current item.
+void* ListDeque_next(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_next(pDeque->list);
+    }
+    if (pDeque->curr < 0 || pDeque->oob_end) {
+        pDeque->oob_end = true;
+        return NULL;
+    }
+    if (++pDeque->curr == pDeque->size) {
+        pDeque->curr = -1;
+        pDeque->oob_end = true;
+        return NULL;
+    }
+    pDeque->oob_end = false;
+    return pDeque->items[slotOf(pDeque, pDeque->curr)];
+}
+
+// Backs up pDeque's current item by one, and returns a pointer to the new current item.
+void* ListDeque_prev(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_prev(pDeque->list);
+    }
+    if (pDeque->curr < 0 || pDeque->oob_start) {
+        pDeque->oob_start = true;
+        return NULL;
+    }
+    if (--pDeque->curr < 0) {
+        pDeque->oob_start = true;
+        return NULL;
+    }
+    pDeque->oob_start = false;
+    return pDeque->items[slotOf(pDeque, pDeque->curr)];
+}
+
+// Returns a pointer to the current item in pDeque, or NULL if there is none.
+void* ListDeque_curr(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return pDeque->list->curr == NULL ? NULL : List_curr(pDeque->list);
+    }
+    if (pDeque->curr < 0) {
+        return NULL;
+    }
+    return pDeque->items[slotOf(pDeque, pDeque->curr)];
+}
+
+// Adds the new item to pDeque directly after the current item, and makes item the current item.
+int ListDeque_insert_after(ListDeque* pDeque, void* pItem) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list == NULL) {
+        // Empty, beyond the end, or at the last item: the item goes at the end
+        if (pDeque->size == 0 || pDeque->curr < 0 || pDeque->oob_end || pDeque->curr == pDeque->size - 1) {
+            return pushBack(pDeque, pItem);
+        }
+        if (toLinked(pDeque) != LIST_SUCCESS) {
+            return LIST_FAIL;
+        }
+    }
+    return List_insert_after(pDeque->list, pItem);
+}
+
+// Adds item to pDeque directly before the current item, and makes the new item the current one.
+int ListDeque_insert_before(ListDeque* pDeque, void* pItem) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list == NULL) {
+        // Empty, before the start, or at the first item: the item goes at the start
+        if (pDeque->size == 0 || pDeque->curr < 0 || pDeque->oob_start || pDeque->curr == 0) {
+            return pushFront(pDeque, pItem);
+        }
+        if (toLinked(pDeque) != LIST_SUCCESS) {
+            return LIST_FAIL;
+        }
+    }
+    return List_insert_before(pDeque->list, pItem);
+}
+
+// Adds item to the end of pDeque, and makes the new item the current one.
+int ListDeque_append(ListDeque* pDeque, void* pItem) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_append(pDeque->list, pItem);
+    }
+    return pushBack(pDeque, pItem);
+}
+
+// Adds item to the front of pDeque, and makes the new item the current one.
+int ListDeque_prepend(ListDeque* pDeque, void* pItem) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_prepend(pDeque->list, pItem);
+    }
+    return pushFront(pDeque, pItem);
+}
+
+// Return current item and take it out of pDeque. Make the next item the current one.
+void* ListDeque_remove(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_remove(pDeque->list);
+    }
+    int position = pDeque->curr;
+    if (position < 0) {
+        return NULL;
+    }
+    void* pItem = pDeque->items[slotOf(pDeque, position)];
+
+    // Close the gap from whichever side has fewer items; either way the next item
+    // ends up at position
+    if (position < pDeque->size - 1 - position) {
+        for (int i = position; i > 0; i--) {
+            pDeque->items[slotOf(pDeque, i)] = pDeque->items[slotOf(pDeque, i - 1)];
+        }
+        pDeque->start = (pDeque->start + 1) & (pDeque->capacity - 1);
+    }
+    else {
+        for (int i = position; i < pDeque->size - 1; i++) {
+            pDeque->items[slotOf(pDeque, i)] = pDeque->items[slotOf(pDeque, i + 1)];
+        }
+    }
+    pDeque->size--;
+    // Past the end there is no next item
+    if (position == pDeque->size) {
+        pDeque->curr = -1;
+    }
+    return pItem;
+}
+
+// Return last item and take it out of pDeque. Make the new last item the current one.
+void* ListDeque_trim(ListDeque* pDeque) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_trim(pDeque->list);
+    }
+    if (pDeque->size == 0) {
+        return NULL;
+    }
+    void* pItem = pDeque->items[slotOf(pDeque, pDeque->size - 1)];
+    if (pDeque->curr == pDeque->size - 1) {
+        pDeque->curr--;
+    }
+    pDeque->size--;
+    return pItem;
+}
+
+// Adds pDeque2 to the end of pDeque1. pDeque2 no longer exists after the operation.
+int ListDeque_concat(ListDeque* pDeque1, ListDeque* pDeque2) {
+    assert(pDeque1 != NULL && pDeque2 != NULL && pDeque1 != pDeque2);
+
+    if (pDeque1->list == NULL && pDeque2->list == NULL) {
+        if (reserve(pDeque1, pDeque1->size + pDeque2->size) != 0) {
+            return LIST_FAIL;
+        }
+        for (int i = 0; i < pDeque2->size; i++) {
+            pDeque1->items[slotOf(pDeque1, pDeque1->size + i)] = pDeque2->items[slotOf(pDeque2, i)];
+        }
+        pDeque1->size += pDeque2->size;
+    }
+    else {
+        // A linked deque can only take linked nodes; converting keeps the items in order,
+        // so a failure part way leaves both holding what they held
+        if ((pDeque1->list == NULL && toLinked(pDeque1) != LIST_SUCCESS)
+            || (pDeque2->list == NULL && toLinked(pDeque2) != LIST_SUCCESS)) {
+            return LIST_FAIL;
+        }
+        List_concat(pDeque1->list, pDeque2->list);
+    }
+    free(pDeque2->items);
+    free(pDeque2);
+    return LIST_SUCCESS;
+}
+
+// Delete pDeque, invoking pItemFreeFn on each item (if pItemFreeFn is not NULL).
+void ListDeque_free(ListDeque* pDeque, FREE_FN pItemFreeFn) {
+    assert(pDeque != NULL);
+
+    if (pDeque->list != NULL) {
+        List_free(pDeque->list, pItemFreeFn);
+    }
+    for (int i = 0; pItemFreeFn != NULL && i < pDeque->size; i++) {
+        pItemFreeFn(pDeque->items[slotOf(pDeque, i)]);
+    }
+    free(pDeque->items);
+    free(pDeque);
+}
+
+// Search pDeque, starting at the current item, until the end is reached or a match is found.
+void* ListDeque_search(ListDeque* pDeque, COMPARATOR_FN pComparator, void* pComparisonArg) {
+    assert(pDeque != NULL && pComparator != NULL);
+
+    if (pDeque->list != NULL) {
+        return List_search(pDeque->list, pComparator, pComparisonArg);
+    }
+    pDeque->oob_start = false;
+    pDeque->oob_end = false;
+
+    // If the current item is before the start of pDeque, start from the first item
+    for (int position = pDeque->curr >= 0 ? pDeque->curr : 0; position < pDeque->size; position++) {
+        void* pItem = pDeque->items[slotOf(pDeque, position)];
+        if (pComparator(pItem, pComparisonArg)) {
+            pDeque->curr = position;
+            return pItem;
+        }
+    }
+
+    pDeque->oob_end = true;
+    pDeque->curr = -1;
+    return NULL;
+}
@@ -0,0 +1,90 @@
+// Deque: the same interface and cursor semantics as List, kept in a growable
+// circular array of item pointers instead of pool nodes. Appending, prepending,
+// trimming and removing at either end touch one slot, and walks and searches
+// read the items in order from contiguous memory.
+//
+// A deque stays an array for as long as items only arrive at its ends. The
+// first insert_after or insert_before in the middle moves every item into a
+// linked List, which then serves all later calls; it never moves back.
+// Removing from the middle of the array shifts the shorter side by one slot.
+
+#ifndef _DEQUE_H_
+#define _DEQUE_H_
+#include "list.h"
+
+// Slots allocated by the first insert; the array doubles whenever it is full
+#define LIST_DEQUE_MIN_CAPACITY 16
+
+typedef struct ListDeque_s ListDeque;
+struct ListDeque_s {
+    void** items;    // capacity slots (a power of two), NULL until the first insert
+    int capacity;
+    int start;       // Slot of the first item
+    int size;
+    int curr;        // Position of the current item (0 is the first), -1 when there is none
+    bool oob_start;  // Flag for out-of-bounds at the start
+    bool oob_end;    // Flag for out-of-bounds at the end
+    List* list;      // Holds the items instead once a middle insert has happened
+};
+
+// Each function below behaves exactly like its List_ counterpart in list.h,
+// including where the current item ends up.
+
+// Makes a new, empty deque, and returns its reference on success.
+// Returns a NULL pointer on failure.
+ListDeque* ListDeque_create();
+
+// Returns the number of items in pDeque.
+int ListDeque_count(ListDeque* pDeque);
+
+// Returns a pointer to the first item in pDeque and makes the first item the current item.
+void* ListDeque_first(ListDeque* pDeque);
+
+// Returns a pointer to the last item in pDeque and makes the last item the current item.
+void* ListDeque_last(ListDeque* pDeque);
+
+// Advances pDeque's current item by one, and returns a pointer to the new current item.
+void* ListDeque_next(ListDeque* pDeque);
+
+// Backs up pDeque's current item by one, and returns a pointer to the new current item.
+void* ListDeque_prev(ListDeque* pDeque);
+
+// Returns a pointer to the current item in pDeque, or NULL if there is none.
+void* ListDeque_curr(ListDeque* pDeque);
+
+// Adds the new item to pDeque directly after the current item, and makes item the current item.
+// Inserting anywhere but at the end moves pDeque to linked nodes.
+// Returns 0 on success, -1 on failure.
+int ListDeque_insert_after(ListDeque* pDeque, void* pItem);
+
+// Adds item to pDeque directly before the current item, and makes the new item the current one.
+// Inserting anywhere but at the start moves pDeque to linked nodes.
+// Returns 0 on success, -1 on failure.
+int ListDeque_insert_before(ListDeque* pDeque, void* pItem);
+
+// Adds item to the end of pDeque, and makes the new item the current one.
+// Returns 0 on success, -1 on failure.
+int ListDeque_append(ListDeque* pDeque, void* pItem);
+
+// Adds item to the front of pDeque, and makes the new item the current one.
+// Returns 0 on success, -1 on failure.
+int ListDeque_prepend(ListDeque* pDeque, void* pItem);
+
+// Return current item and take it out of pDeque. Make the next item the current one.
+void* ListDeque_remove(ListDeque* pDeque);
+
+// Return last item and take it out of pDeque. Make the new last item the current one.
+void* ListDeque_trim(ListDeque* pDeque);
+
+// Adds pDeque2 to the end of pDeque1. pDeque2 no longer exists after the operation.
+// Unlike List_concat this may need memory; returns 0 on success, or -1 on failure,
+// with both deques left as they were.
+int ListDeque_concat(ListDeque* pDeque1, ListDeque* pDeque2);
+
+// Delete pDeque, invoking pItemFreeFn on each item (if pItemFreeFn is not NULL).
+void ListDeque_free(ListDeque* pDeque, FREE_FN pItemFreeFn);
+
+// Search pDeque, starting at the current item, until the end is reached or a match is found.
+void* ListDeque_search(ListDeque* pDeque, COMPARATOR_FN pComparator, void* pComparisonArg);
+
+#endif
@@ -0,0 +1,295 @@
+#include "ilist.h"
+#include <assert.h>
+
+// Makes pList an empty list.
+void IList_init(IList* pList) {
+    assert(pList != NULL);
+
+    pList->head = NULL;
+    pList->tail = NULL;
+    pList->curr = NULL;
+    pList->size = 0;
+    pList->oob_start = false;
+    pList->oob_end = false;
+}
+
+// Returns the number of links in pList.
+int IList_count(IList* pList) {
+    return pList->size;
+}
+
+// Returns the first link in pList and makes it the current one.
+IListLink* IList_first(IList* pList) {
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->curr = pList->head;
+    return pList->curr;
+}
+
+// Returns the last link in pList and makes it the current one.
+IListLink* IList_last(IList* pList) {
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->curr = pList->tail;
+    return pList->curr;
+}
+
+// Advances pList's current link by one, and returns the new current link.
+IListLink* IList_next(IList* pList) {
+    assert(pList != NULL);
+
+    if (pList->curr == NULL || pList->oob_end) {
+        pList->oob_end = true;
+        return NULL;
+    }
+    pList->curr = pList->curr->next;
+    if (pList->curr == NULL) {
+        pList->oob_end = true;
+        return NULL;
+    }
+    pList->oob_end = false;
+    return pList->curr;
+}
+
+// Backs up pList's current link by one, and returns the new current link.
+IListLink* IList_prev(IList* pList) {
+    assert(pList != NULL);
+
+    if (pList->curr == NULL || pList->oob_start) {
+        pList->oob_start = true;
+        return NULL;
+    }
+    pList->curr = pList->curr->prev;
+    if (pList->curr == NULL) {
+        pList->oob_start = true;
+        return NULL;
+    }
+    pList->oob_start = false;
+    return pList->curr;
+}
+
+// Returns the current link in pList, or NULL if there is none.
+IListLink* IList_curr(IList* pList) {
+    assert(pList != NULL);
+
+    return pList->curr;
+}
+
+// Adds link to pList directly after the current link, and makes it the current one.
+void IList_insert_after(IList* pList, IListLink* link) {
+    assert(pList != NULL && link != NULL);
+
+    // If the list is empty, add to the start, which is also the end.
+    if (pList->head == NULL) {
+        link->next = NULL;
+        link->prev = NULL;
+        pList->head = link;
+        pList->tail = link;
+    }
+    // If curr is beyond the end, add to the end.
+    else if (pList->curr == NULL || pList->oob_end) {
+        link->next = NULL;
+        link->prev = pList->tail;
+        pList->tail->next = link;
+        pList->tail = link;
+    }
+    // If curr is not NULL, add after curr.
+    else {
+        link->next = pList->curr->next;
+        link->prev = pList->curr;
+        if (pList->curr->next == NULL) {
+            pList->tail = link;
+        }
+        else {
+            pList->curr->next->prev = link;
+        }
+        pList->curr->next = link;
+    }
+    pList->curr = link;
+    pList->size++;
+}
+
+// Adds link to pList directly before the current link, and makes it the current one.
+void IList_insert_before(IList* pList, IListLink* link) {
+    assert(pList != NULL && link != NULL);
+
+    // If the list is empty, add to start.
+    if (pList->head == NULL) {
+        link->next = NULL;
+        link->prev = NULL;
+        pList->head = link;
+        pList->tail = link;
+    }
+    // If curr is before the start, add to start.
+    else if (pList->curr == NULL || pList->oob_start) {
+        link->next = pList->head;
+        link->prev = NULL;
+        pList->head->prev = link;
+        pList->head = link;
+    }
+    // If curr is not NULL, add before curr.
+    else {
+        link->next = pList->curr;
+        link->prev = pList->curr->prev;
+        if (pList->curr->prev != NULL) {
+            pList->curr->prev->next = link;
+        }
+        else {
+            pList->head = link;
+        }
+        pList->curr->prev = link;
+    }
+    pList->curr = link;
+    pList->size++;
+}
+
+// Adds link to the end of pList, and makes it the current one.
+void IList_append(IList* pList, IListLink* link) {
+    assert(pList != NULL && link != NULL);
+
+    link->next = NULL;
+    link->prev = pList->tail;
+    if (pList->tail == NULL) {
+        pList->head = link;
+    }
+    else {
+        pList->tail->next = link;
+    }
+    pList->tail = link;
+    pList->curr = link;
+    pList->size++;
+}
+
+// Adds link to the front of pList, and makes it the current one.
+void IList_prepend(IList* pList, IListLink* link) {
+    assert(pList != NULL && link != NULL);
+
+    link->next = pList->head;
+    link->prev = NULL;
+    if (pList->head == NULL) {
+        pList->tail = link;
+    }
+    else {
+        pList->head->prev = link;
+    }
+    pList->head = link;
+    pList->curr = link;
+    pList->size++;
+}
+
+// Return current link and take it out of pList. Make the next link the current one.
+IListLink* IList_remove(IList* pList) {
+    assert(pList != NULL);
+
+    IListLink* link = pList->curr;
+    if (link == NULL) {
+        return NULL;
+    }
+
+    if (link->prev != NULL) {
+        link->prev->next = link->next;
+    }
+    else {
+        pList->head = link->next;
+    }
+    if (link->next != NULL) {
+        link->next->prev = link->prev;
+    }
+    else {
+        pList->tail = link->prev;
+    }
+    // The next link becomes current; past the end there is none
+    pList->curr = link->next;
+    pList->size--;
+
+    link->next = NULL;
+    link->prev = NULL;
+    return link;
+}
+
+// Return last link and take it out of pList. Make the new last link the current one.
+IListLink* IList_trim(IList* pList) {
+    assert(pList != NULL);
+
+    IListLink* link = pList->tail;
+    if (link == NULL) {
+        return NULL;
+    }
+
+    pList->tail = link->prev;
+    if (pList->tail != NULL) {
+        pList->tail->next = NULL;
+    }
+    else {
+        pList->head = NULL;
+    }
+    if (pList->curr == link) {
+        pList->curr = pList->tail;
+    }
+    pList->size--;
+
+    link->next = NULL;
+    link->prev = NULL;
+    return link;
+}
+
+// Adds pList2 to the end of pList1. pList2 is left empty.
+void IList_concat(IList* pList1, IList* pList2) {
+    assert(pList1 != NULL && pList2 != NULL && pList1 != pList2);
+
+    if (pList2->head != NULL) {
+        if (pList1->tail != NULL) {
+            pList1->tail->next = pList2->head;
+            pList2->head->prev = pList1->tail;
+        }
+        else {
+            pList1->head = pList2->head;
+        }
+        pList1->tail = pList2->tail;
+        pList1->size += pList2->size;
+    }
+    IList_init(pList2);
+}
+
+// Takes every link out of pList, invoking pLinkFreeFn on each (if it is not NULL).
+void IList_clear(IList* pList, FREE_FN pLinkFreeFn) {
+    assert(pList != NULL);
+
+    IListLink* link = pList->head;
+    while (link != NULL) {
+        // Read next first: the free function may release the record holding link
+        IListLink* next = link->next;
+        link->next = NULL;
+        link->prev = NULL;
+        if (pLinkFreeFn != NULL) {
+            pLinkFreeFn(link);
+        }
+        link = next;
+    }
+    IList_init(pList);
+}
+
+// Search pList, starting at the current link, until the end is reached or a match is found.
+IListLink* IList_search(IList* pList, COMPARATOR_FN pComparator, void* pComparisonArg) {
+    assert(pList != NULL && pComparator != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+
+    // If the current pointer is before the start of the pList, start from the head
+    IListLink* link = pList->curr != NULL ? pList->curr : pList->head;
+    for (; link != NULL; link = link->next) {
+        if (pComparator(link, pComparisonArg)) {
+            pList->curr = link;
+            return link;
+        }
+    }
+
+    pList->oob_end = true;
+    pList->curr = NULL;
+    return NULL;
+}
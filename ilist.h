@@ -0,0 +1,96 @@
+// Intrusive list: the same cursor and search semantics as List, but the links
+// live inside the caller's own records. Embed an IListLink in a record, hand the
+// link to the list, and get the record back with ILIST_ENTRY. Nothing is
+// allocated, so inserts cannot fail, and visiting an item touches only the
+// record itself rather than a pool node and then the item.
+//
+//     struct Connection { int fd; IListLink link; };
+//     IList_append(&open, &conn->link);
+//     struct Connection* c = ILIST_ENTRY(IList_first(&open), struct Connection, link);
+
+#ifndef _ILIST_H_
+#define _ILIST_H_
+#include "list.h"
+#include <stddef.h>
+
+typedef struct IListLink_s IListLink;
+struct IListLink_s {
+    IListLink* next;
+    IListLink* prev;
+};
+
+// Recovers the record of the given type whose field member is the link.
+// A NULL link gives NULL.
+#define ILIST_ENTRY(link, type, member) \
+    ((type*)ilistEntry((link), offsetof(type, member)))
+
+static inline void* ilistEntry(IListLink* link, size_t offset) {
+    return link == NULL ? NULL : (char*)link - offset;
+}
+
+// The caller owns the list head too: declare it anywhere and IList_init it.
+typedef struct IList_s IList;
+struct IList_s {
+    IListLink* head;
+    IListLink* tail;
+    IListLink* curr;
+    int size;
+    bool oob_start;  // Flag for out-of-bounds at the start
+    bool oob_end;    // Flag for out-of-bounds at the end
+};
+
+// Each function below behaves like its List_ counterpart in list.h, including
+// where the current item ends up, with links in place of item pointers.
+// A link can be in only one list at a time. Removing a link clears it.
+
+// Makes pList an empty list.
+void IList_init(IList* pList);
+
+// Returns the number of links in pList.
+int IList_count(IList* pList);
+
+// Returns the first link in pList and makes it the current one.
+IListLink* IList_first(IList* pList);
+
+// Returns the last link in pList and makes it the current one.
+IListLink* IList_last(IList* pList);
+
+// Advances pList's current link by one, and returns the new current link.
+IListLink* IList_next(IList* pList);
+
+// Backs up pList's current link by one, and returns the new current link.
+IListLink* IList_prev(IList* pList);
+
+// Returns the current link in pList, or NULL if there is none.
+IListLink* IList_curr(IList* pList);
+
+// Adds link to pList directly after the current link, and makes it the current one.
+void IList_insert_after(IList* pList, IListLink* link);
+
+// Adds link to pList directly before the current link, and makes it the current one.
+void IList_insert_before(IList* pList, IListLink* link);
+
+// Adds link to the end of pList, and makes it the current one.
+void IList_append(IList* pList, IListLink* link);
+
+// Adds link to the front of pList, and makes it the current one.
+void IList_prepend(IList* pList, IListLink* link);
+
+// Return current link and take it out of pList. Make the next link the current one.
+IListLink* IList_remove(IList* pList);
+
+// Return last link and take it out of pList. Make the new last link the current one.
+IListLink* IList_trim(IList* pList);
+
+// Adds pList2 to the end of pList1. pList2 is left empty.
+void IList_concat(IList* pList1, IList* pList2);
+
+// Takes every link out of pList, invoking pLinkFreeFn on each (if it is not NULL),
+// and leaves pList empty. The function receives the IListLink* and may free its record.
+void IList_clear(IList* pList, FREE_FN pLinkFreeFn);
+
+// Search pList, starting at the current link, until the end is reached or a match is
+// found. pComparator receives each IListLink* as its item.
+IListLink* IList_search(IList* pList, COMPARATOR_FN pComparator, void* pComparisonArg);
+
+#endif
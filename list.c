@@ -1,530 +1,2820 @@
 #include "list.h"
+#include "list_internal.h"
+#include "pool.h"
 #include <assert.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Older C libraries lack this; mapping at a hint is then checked after the fact
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0
+#endif
+
+// An arena owns pools for list nodes and heads. Both grow on demand one slab at
+// a time, and slabs are never moved, so Node and List pointers stay valid until
+// the arena is reset. List_create uses the default arena; List_create_in takes
+// another one.
+//
+// The pools themselves are not thread-safe. Each arena's node pool acts as a depot
+// behind nodeLock. For the default arena, each thread also keeps a magazine of
+// free node indices in front of it, so most allocations and frees take no lock.
+// Heads are allocated rarely enough that a plain lock around the head pool is fine.
+typedef struct ArenaFile_s ArenaFile;
+
+struct ListArena_s {
+    Pool nodePool;
+    Pool listPool;
+    pthread_mutex_t nodeLock; // Guards nodePool and the free chain
+    pthread_mutex_t headLock; // Guards listPool and indexes
+
+    // Whole lists released by List_free go back to the depot as one chain, linked
+    // through their next links, rather than node by node
+    Node* freeChain;
+    int freeChainLength;
+
+    ListIndex* indexes; // Hash indexes of the arena's lists, for ListArena_reset to free
+
+    // Bytes of item storage directly after each node, 0 if items are only referenced.
+    // An inline item's data pointer points at its own node's storage.
+    size_t payloadSize;
+
+    ArenaFile* file; // For an arena opened with ListArena_open, the file it lives in
+};
+
+static ListArena defaultArena = {
+    .nodeLock = PTHREAD_MUTEX_INITIALIZER,
+    .headLock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// A persistent arena lives in a file laid out as an ArenaFile header (which holds the
+// ListArena itself), the pools' slab number arrays and free stacks, then the node
+// slabs and the head slabs. The file is always mapped at the address it was made
+// at, so the node and list pointers stored in it stay valid from run to run.
+#define ARENA_FILE_MAGIC "LISTAREN"
+#define ARENA_FILE_VERSION 1
+
+struct ArenaFile_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeSize;  // sizeof(Node) and sizeof(List) in the build that made the file
+    uint32_t listSize;
+    uint32_t dirty;     // Set while the file is open, so it is still set after a crash
+    uint64_t fileSize;
+    uintptr_t base;     // Where the file has to be mapped
+    int nodeSlabs;
+    int headSlabs;
+    List* roots[LIST_ARENA_ROOTS];
+    ListArena arena;
+};
+
+// Byte offsets of the parts of an arena file
+typedef struct ArenaFileLayout_s ArenaFileLayout;
+struct ArenaFileLayout_s {
+    size_t nodeSlabNumbers;
+    size_t headSlabNumbers;
+    size_t nodeFreeStack;
+    size_t headFreeStack;
+    size_t nodeSlabs;
+    size_t headSlabs;
+    size_t fileSize;
+    size_t alignment;   // Of the whole mapping: the larger slab size
+};
+
+// Every arena's node slabs are numbered in one directory, so a node index is
+// unique across arenas and compact links decode without knowing the arena.
+// Heads share a directory too, which saves each arena allocating its own.
+static PoolDirectory nodeDirectory = POOL_DIRECTORY_INITIALIZER;
+static PoolDirectory headDirectory = POOL_DIRECTORY_INITIALIZER;
+
+// Magazine capacity, and how many indices move between a magazine and the depot at once
+#define NODE_MAGAZINE_SIZE 64
+#define NODE_MAGAZINE_BATCH 32
+
+// Per-thread counters behind List_get_pool_stats. Only the owning thread writes
+// them, so updates are a relaxed load and store rather than a locked add, and
+// readers sum every thread's copy.
+typedef struct ThreadStats_s ThreadStats;
+struct ThreadStats_s {
+    _Atomic uint64_t nodeAllocs;
+    _Atomic uint64_t nodeFrees;
+    _Atomic uint64_t nodeAllocFailures;
+    _Atomic uint64_t searchLengths[LIST_SEARCH_HISTOGRAM_BUCKETS];
+};
+
+typedef struct NodeMagazine_s NodeMagazine;
+struct NodeMagazine_s {
+    int count;
+    bool registered; // Whether the thread-exit flush is set up for this thread
+    int indices[NODE_MAGAZINE_SIZE];
+    ThreadStats stats;
+    NodeMagazine* nextRegistered; // Next live thread's magazine, under statsLock
+};
+static _Thread_local NodeMagazine nodeMagazine;
+static pthread_key_t nodeMagazineKey;
+
+// Every live thread's magazine, so its stats can be summed, plus the totals
+// of threads that have exited
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+static NodeMagazine* registeredMagazines = NULL;
+static ThreadStats exitedThreadStats;
+
+static pthread_once_t poolsInitialized = PTHREAD_ONCE_INIT; // Keep track of whether pools have been initialized
+static pthread_once_t headpoolsInitialized = PTHREAD_ONCE_INIT; // Keep track of whether head pools have been initialized
+
+// Link accessors. With LIST_COMPACT_LINKS, next/prev hold 32-bit node pool
+// indices instead of pointers, and NULL is stored as LIST_NIL_LINK.
+#ifdef LIST_COMPACT_LINKS
+static inline Node* linkToNode(NodeLink link) {
+    if (link == LIST_NIL_LINK) {
+        return NULL;
+    }
+    // Same as Pool_at, but with the stride known at compile time
+    return (Node*)(nodeDirectory.slabs[link >> POOL_SLAB_SHIFT] + POOL_SLAB_HEADER) + (link & (POOL_SLAB_SIZE - 1));
+}
 
-// Define a static pool for list nodes and heads
-static Node nodePool[LIST_MAX_NUM_NODES];
-static List listPool[LIST_MAX_NUM_HEADS];
-
-// Variables to track the usage of nodes and heads
-static int numFreeNodes = LIST_MAX_NUM_NODES;
-static int numFreeHeads = LIST_MAX_NUM_HEADS;
-static int poolsInitialized = 0; // Keep track of whether pools have been initialized
-static int headpoolsInitialized = 0; // Keep track of whether head pools have been initialized
+static inline NodeLink nodeToLink(Node* node) {
+    // Every arena's node pool has the default one's geometry
+    return node == NULL ? LIST_NIL_LINK : (NodeLink)Pool_indexOf(&defaultArena.nodePool, node);
+}
+#else
+static inline Node* linkToNode(NodeLink link) {
+    return link;
+}
 
-// Stack to keep track of free nodes
-static int freeNodeStack[LIST_MAX_NUM_NODES];
-static int StackTopINdx = -1; // Initialize stack top to -1 to indicate empty stack
+static inline NodeLink nodeToLink(Node* node) {
+    return node;
+}
+#endif
 
-static int freeListStack[LIST_MAX_NUM_HEADS];
-static int listStackTopINdx = -1; // Initialize stack top to -1 to indicate empty stack
+// Next links and list heads are loaded with acquire and stored with release, so that a
+// reader of an RCU list that sees a link to a node also sees what the node holds.
+// On x86 both are plain moves.
+static inline Node* nodeNext(Node* node) {
+    return linkToNode(__atomic_load_n(&node->next, __ATOMIC_ACQUIRE));
+}
 
-// Updated function to initialize the static node pool and free node stack
-static void initializeNodePool() {
-    for (int i = 0; i < LIST_MAX_NUM_NODES; i++) {
-        nodePool[i].next = NULL;
-        nodePool[i].prev = NULL;
-        nodePool[i].data = NULL;
-        // Push the node index stack 
-        freeNodeStack[i] = i;
-    }
-    StackTopINdx = LIST_MAX_NUM_NODES - 1; // Set the top of the stack to the last index
+static inline Node* nodePrev(Node* node) {
+    return linkToNode(node->prev);
 }
 
-//FUnction to make sure the node pool is initalized only once
-static void initializePoolsIfNeeded() {
-    if (!poolsInitialized) {
-        initializeNodePool();
-        poolsInitialized = 1;
-    }
+static inline void setNodeNext(Node* node, Node* next) {
+    __atomic_store_n(&node->next, nodeToLink(next), __ATOMIC_RELEASE);
 }
-// Function to initialize the static list head pool
-static void initializeListPool() {
-    for (int i = 0; i < LIST_MAX_NUM_HEADS; i++) {
-        listPool[i].head = NULL;
-        listPool[i].tail = NULL;
-        listPool[i].curr = NULL;
-        listPool[i].size = 0;
-        listPool[i].oob_start = false;
-        listPool[i].oob_end = false;
 
-        //push free head into the empty stack
-        freeListStack[i] = i;
-    }
-    listStackTopINdx = LIST_MAX_NUM_HEADS - 1; // Set the top of the stack to the last index
+static inline void setNodePrev(Node* node, Node* prev) {
+    node->prev = nodeToLink(prev);
 }
 
-//FUnction to make sure the node pool is initalized only once
-static void initializeHeadPoolsIfNeeded() {
-    if (!headpoolsInitialized) {
-        initializeListPool();
-        headpoolsInitialized = 1;
-    }
+static inline Node* listHead(List* pList) {
+    return __atomic_load_n(&pList->head, __ATOMIC_ACQUIRE);
 }
 
-// function to find and allocate a free node in O(1) time
-static Node* allocateNode() {
-    if (StackTopINdx < 0) {
-        return NULL; // No free nodes available
-    }
-    // Pop a node index off the stack of free nodes
-    int nodeIndex = freeNodeStack[StackTopINdx--];
-    numFreeNodes--;
-    return &nodePool[nodeIndex];
+static inline void setListHead(List* pList, Node* head) {
+    __atomic_store_n(&pList->head, head, __ATOMIC_RELEASE);
 }
 
-// function to free a node in O(1) time
-static void freeNode(Node* node) {
+// Inline item storage follows the node, padded so that it is 8-byte aligned
+#define INLINE_PAYLOAD_ALIGN 8
 
-    if (node != NULL) {
-        node->data = NULL;
-        node->next = NULL;
-        node->prev = NULL;
-        // Push the node index onto the stack of free nodes
-        int nodeIndex = node - nodePool; // Calculate index based on pointer arithmetic
-        freeNodeStack[++StackTopINdx] = nodeIndex;
-        numFreeNodes++;
-    } 
+static inline void* nodePayload(Node* node) {
+    return node + 1;
 }
 
-//######################################################################################################################
-//######################################################################################################################
-
-// Makes a new, empty list, and returns its reference on success. 
-// Returns a NULL pointer on failure.
-List* List_create(){
+// Whether node's item is stored in the node itself rather than referenced
+static inline bool isInlineItem(Node* node) {
+    return node->data == nodePayload(node);
+}
 
-    //Initialize the node pool
-    initializePoolsIfNeeded();
-    // Initialize the list head pool if it hasn't been initialized yet
-    initializeHeadPoolsIfNeeded();
+// Adds n to a counter that only the calling thread writes
+static inline void addCount(_Atomic uint64_t* counter, uint64_t n) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
 
-    if (listStackTopINdx < 0) {
-        return NULL; // No free list heads available
+// Adds every counter in from to the matching counter in to
+static void addThreadStats(ThreadStats* to, ThreadStats* from) {
+    addCount(&to->nodeAllocs, atomic_load_explicit(&from->nodeAllocs, memory_order_relaxed));
+    addCount(&to->nodeFrees, atomic_load_explicit(&from->nodeFrees, memory_order_relaxed));
+    addCount(&to->nodeAllocFailures, atomic_load_explicit(&from->nodeAllocFailures, memory_order_relaxed));
+    for (int i = 0; i < LIST_SEARCH_HISTOGRAM_BUCKETS; i++) {
+        addCount(&to->searchLengths[i], atomic_load_explicit(&from->searchLengths[i], memory_order_relaxed));
     }
-    // Pop a list head index off the stack of free list heads
-    int listIndex = freeListStack[listStackTopINdx];
-    listStackTopINdx--;
-    numFreeHeads--;
-
-    return &listPool[listIndex];
 }
 
-// Returns the number of items in pList.
-int List_count(List* pList){
-    return pList->size;
+// Software prefetching for the hot loops. List_search and List_free send a second
+// pointer LIST_PREFETCH_DISTANCE nodes ahead of the one being visited and prefetch
+// each item it passes, so an item's cache miss overlaps with walking the links
+// before it is reached (the lookahead itself is in list.h, for the search loops
+// list_typed.h generates). Walks through List_next and List_prev prefetch one node ahead.
+// Build with -DLIST_PREFETCH_DISTANCE=0 to turn all of this off.
+static inline Node* startLookahead(Node* node) {
+    return List_lookahead_start(node, nodeNext);
 }
 
-// Returns a pointer to the first item in pList and makes the first item the current item.
-// Returns NULL and sets current item to NULL if list is empty.
-void* List_first(List* pList){
-    assert(pList != NULL);
+static inline Node* advanceLookahead(Node* ahead) {
+    return List_lookahead_advance(ahead, nodeNext);
+}
 
-    pList->curr = pList->head;//sets the first item the current item
-    if (pList->curr == NULL) {
-        return NULL;
+// Prefetches a node that a cursor walk is about to reach
+static inline void prefetchNode(Node* node) {
+    if (LIST_PREFETCH_DISTANCE > 0) {
+        __builtin_prefetch(node); // Prefetching NULL is harmless
     }
-    return pList->curr->data;// void pointer to the item
 }
 
-// Returns a pointer to the last item in pList and makes the last item the current item.
-// Returns NULL and sets current item to NULL if list is empty.
-void* List_last(List* pList){
-    assert(pList != NULL);
-
-    pList->curr = pList->tail;//sets the last item the current item
-    if (pList->curr == NULL) {
-        return NULL;
+// Hands a thread's cached node indices back to the depot when the thread exits,
+// and folds its stats into the totals for exited threads
+static void flushNodeMagazine(void* magazine) {
+    NodeMagazine* pMagazine = magazine;
+    pthread_mutex_lock(&defaultArena.nodeLock);
+    Pool_freeBatch(&defaultArena.nodePool, pMagazine->indices, pMagazine->count);
+    pthread_mutex_unlock(&defaultArena.nodeLock);
+    pMagazine->count = 0;
+
+    pthread_mutex_lock(&statsLock);
+    addThreadStats(&exitedThreadStats, &pMagazine->stats);
+    NodeMagazine** link = &registeredMagazines;
+    while (*link != pMagazine) {
+        link = &(*link)->nextRegistered;
     }
-    return pList->curr->data;// void pointer to the item
+    *link = pMagazine->nextRegistered;
+    pthread_mutex_unlock(&statsLock);
+    pMagazine->stats = (ThreadStats){ 0 };
+    pMagazine->registered = false;
 }
 
-// Advances pList's current item by one, and returns a pointer to the new current item.
-// If this operation advances the current item beyond the end of the pList, a NULL pointer 
-// is returned and the current item is set to be beyond end of pList.
-void* List_next(List* pList){
+// Function to initialize the node pool. Slabs are mapped zeroed, so nodes start out clear.
+static void initializeNodePool() {
+    Pool_initShared(&defaultArena.nodePool, sizeof(Node), &nodeDirectory);
+    pthread_key_create(&nodeMagazineKey, flushNodeMagazine);
+}
 
-    assert(pList != NULL);
+//FUnction to make sure the node pool is initalized only once
+static void initializePoolsIfNeeded() {
+    pthread_once(&poolsInitialized, initializeNodePool);
+}
+// Function to initialize the list head pool
+static void initializeListPool() {
+    Pool_initShared(&defaultArena.listPool, sizeof(List), &headDirectory);
+}
 
-    // Check if the list is empty or if we are already out of bounds at the end
-    if (pList->curr == NULL || pList->oob_end) {
-        // already at the end and trying to move forward, set the flag
-        pList->oob_end = true;
-        return NULL;
-    }
+//FUnction to make sure the node pool is initalized only once
+static void initializeHeadPoolsIfNeeded() {
+    pthread_once(&headpoolsInitialized, initializeListPool);
+}
 
-    // Move the current pointer forward
-    pList->curr = pList->curr->next;
-   
-    // Check if we have moved out of bounds at the end
-    if (pList->curr == NULL) {
-        pList->oob_end = true;
-        return NULL;
+// Pops one node index from arena's depot; its nodeLock must be held. Whole chains
+// released by List_free are used up before the pool's free stack.
+static int depotAllocNodeIndex(ListArena* arena) {
+    if (arena->freeChain != NULL) {
+        Node* node = arena->freeChain;
+        arena->freeChain = nodeNext(node);
+        arena->freeChainLength--;
+        return Pool_indexOf(&arena->nodePool, node);
     }
-
-    // successfully moved forward, reset out-of-bounds flags
-    pList->oob_end = false;
-    return pList->curr->data;
+    return Pool_alloc(&arena->nodePool);
 }
 
-// Backs up pList's current item by one, and returns a pointer to the new current item. 
-// If this operation backs up the current item beyond the start of the pList, a NULL pointer 
-// is returned and the current item is set to be before the start of pList.
-void* List_prev(List* pList){
+static NodeMagazine* currentMagazine(void);
 
-    assert(pList != NULL);
+// Puts the chain first..last (linked through next) in front of arena's depot, so its
+// nodes are the next handed out; its nodeLock must be held
+static void depotPushChain(ListArena* arena, Node* first, Node* last, int length) {
+    setNodeNext(last, arena->freeChain);
+    arena->freeChain = first;
+    arena->freeChainLength += length;
+}
 
-    // Check if the list is empty or if we are already out of bounds at the start
-    if (pList->curr == NULL || pList->oob_start) {
-        // already at the start and trying to move back, set the flag
-        pList->oob_start = true;
-        return NULL;
+// Hands the chain first..last (linked through next) to arena's depot in O(1) time
+static void depotFreeChain(ListArena* arena, Node* first, Node* last, int length) {
+    if (arena == &defaultArena) {
+        addCount(&currentMagazine()->stats.nodeFrees, length);
     }
+    pthread_mutex_lock(&arena->nodeLock);
+    depotPushChain(arena, first, last, length);
+    pthread_mutex_unlock(&arena->nodeLock);
+}
 
-    // Move the current pointer back
-    pList->curr = pList->curr->prev;
-    
-    // Check if we have moved out of bounds at the start
-    if (pList->curr == NULL) {
-        pList->oob_start = true;
-        return NULL;
+// Arranges for a thread's magazine to be flushed when the thread exits, and
+// makes its stats visible to List_get_pool_stats
+static void registerNodeMagazine(NodeMagazine* pMagazine) {
+    pthread_setspecific(nodeMagazineKey, pMagazine);
+    pthread_mutex_lock(&statsLock);
+    pMagazine->nextRegistered = registeredMagazines;
+    registeredMagazines = pMagazine;
+    pthread_mutex_unlock(&statsLock);
+    pMagazine->registered = true;
+}
+
+// Returns this thread's magazine, registering it on first use
+static NodeMagazine* currentMagazine(void) {
+    NodeMagazine* pMagazine = &nodeMagazine;
+    if (!pMagazine->registered) {
+        registerNodeMagazine(pMagazine);
     }
+    return pMagazine;
+}
 
-    // successfully moved back, reset out-of-bounds flags
-    pList->oob_start = false;
-    return pList->curr->data;
+// Refills this thread's magazine with a batch from the depot.
+// Returns 0 on success, -1 if the pool cannot grow.
+static int refillNodeMagazine(NodeMagazine* pMagazine) {
+    pthread_mutex_lock(&defaultArena.nodeLock);
+    int count = 0;
+    int nodeIndex;
+    while (count < NODE_MAGAZINE_BATCH && (nodeIndex = depotAllocNodeIndex(&defaultArena)) >= 0) {
+        pMagazine->indices[count++] = nodeIndex;
+    }
+    pthread_mutex_unlock(&defaultArena.nodeLock);
+    pMagazine->count = count;
+    return count > 0 ? 0 : -1;
 }
 
-// Returns a pointer to the current item in pList.
-void* List_curr(List* pList){
-    assert(pList != NULL);
+// Pops a free node index off this thread's magazine in O(1) time, refilling
+// it from the depot if it is empty. Returns -1 if the pool cannot grow.
+int listAllocNodeIndex(void) {
+    NodeMagazine* pMagazine = currentMagazine();
+    if (pMagazine->count == 0 && refillNodeMagazine(pMagazine) != 0) {
+        addCount(&pMagazine->stats.nodeAllocFailures, 1);
+        return -1; // No memory for another slab
+    }
+    addCount(&pMagazine->stats.nodeAllocs, 1);
+    return pMagazine->indices[--pMagazine->count];
+}
 
-    return pList->curr->data;
+// Pushes a node index onto this thread's magazine in O(1) time, spilling a
+// batch to the depot if it is full
+void listFreeNodeIndex(int nodeIndex) {
+    NodeMagazine* pMagazine = currentMagazine();
+    addCount(&pMagazine->stats.nodeFrees, 1);
+    if (pMagazine->count == NODE_MAGAZINE_SIZE) {
+        pMagazine->count -= NODE_MAGAZINE_BATCH;
+        pthread_mutex_lock(&defaultArena.nodeLock);
+        Pool_freeBatch(&defaultArena.nodePool, &pMagazine->indices[pMagazine->count], NODE_MAGAZINE_BATCH);
+        pthread_mutex_unlock(&defaultArena.nodeLock);
+    }
+    pMagazine->indices[pMagazine->count++] = nodeIndex;
 }
 
-// Adds the new item to pList directly after the current item, and makes item the current item. 
-// If the current pointer is before the start of the pList, the item is added at the start. If 
-// the current pointer is beyond the end of the pList, the item is added at the end. 
-// Returns 0 on success, -1 on failure.
-int List_insert_after(List* pList, void* pItem){
-   assert(pList != NULL);
+Pool* listNodePool(void) {
+    initializePoolsIfNeeded();
+    return &defaultArena.nodePool;
+}
 
-    Node* newNode = allocateNode();
-    if (newNode == NULL) {
-        return -1; // Allocation failed
+// function to find and allocate a free node from arena in O(1) time
+static Node* allocateNode(ListArena* arena) {
+    int nodeIndex;
+    if (arena == &defaultArena) {
+        nodeIndex = listAllocNodeIndex();
     }
-    newNode->data = pItem;
+    else {
+        pthread_mutex_lock(&arena->nodeLock);
+        nodeIndex = depotAllocNodeIndex(arena);
+        pthread_mutex_unlock(&arena->nodeLock);
+    }
+    if (nodeIndex < 0) {
+        return NULL;
+    }
+    // Nodes may come back from other users of the pool with stale links, so clear them here
+    Node* node = Pool_at(&arena->nodePool, nodeIndex);
+    setNodeNext(node, NULL);
+    setNodePrev(node, NULL);
+    return node;
+}
 
-    // If the list is empty, add to the start, which is also the end.
-    if (pList->head == NULL) {
-        pList->head = newNode;
-        pList->tail = newNode;
-        pList->curr = newNode; // Set current to the new node
+// function to free a node back to arena in O(1) time
+static void freeNode(ListArena* arena, Node* node) {
+
+    if (node == NULL) {
+        return;
     }
-    // If curr is beyond the end, add to the end.
-    else if (pList->curr == NULL || pList->oob_end) {
-        pList->tail->next = newNode;
-        newNode->prev = pList->tail;
-        pList->tail = newNode;
-        pList->curr = newNode; // Set current to the new node
+    int nodeIndex = Pool_indexOf(&arena->nodePool, node);
+    if (arena == &defaultArena) {
+        listFreeNodeIndex(nodeIndex);
     }
-    // If curr is not NULL, add after curr.
     else {
-        newNode->next = pList->curr->next;
-        newNode->prev = pList->curr;
-        if (pList->curr->next == NULL) { // curr was at the end
-            pList->tail = newNode;
-        } else { // curr was not at the end
-            pList->curr->next->prev = newNode;
-        }
-        pList->curr->next = newNode;
-        pList->curr = newNode; // set current to new node
+        pthread_mutex_lock(&arena->nodeLock);
+        Pool_free(&arena->nodePool, nodeIndex);
+        pthread_mutex_unlock(&arena->nodeLock);
     }
-
-    pList->size++;
-    return 0;
-
 }
 
-// Adds item to pList directly before the current item, and makes the new item the current one. 
-// If the current pointer is before the start of the pList, the item is added at the start. 
-// If the current pointer is beyond the end of the pList, the item is added at the end. 
-// Returns 0 on success, -1 on failure.
-int List_insert_before(List* pList, void* pItem){
-    assert(pList != NULL);
-
-    Node* newNode = allocateNode();
-    if (newNode == NULL) {
-        return -1;
+// Frees the nodes an RCU list has retired. No reader may still be able to reach them.
+static void freeRetired(List* pList) {
+    if (pList->retired == NULL) {
+        return;
     }
-    newNode->data = pItem;
-
-    // If the list is empty, add to start.
-    if (pList->head == NULL) {
-        pList->head = newNode;
-        pList->tail = newNode;
+    // Relink the retired chain through next, for the depot
+    Node* first = pList->retired;
+    Node* last = first;
+    for (Node* older = nodePrev(last); older != NULL; older = nodePrev(last)) {
+        setNodeNext(last, older);
+        last = older;
     }
-    // If curr is before the start, add to start.
-    else if (pList->curr == NULL || pList->oob_start) {
-        newNode->next = pList->head;
-        pList->head->prev = newNode;
-        pList->head = newNode;
+    setNodeNext(last, NULL);
+    depotFreeChain(pList->arena, first, last, pList->numRetired);
+    pList->retired = NULL;
+    pList->numRetired = 0;
+}
+
+// Gives a node taken out of pList back to its arena. An RCU list retires it instead,
+// until no reader can still be looking at it.
+static void releaseNode(List* pList, Node* node) {
+    if (!pList->rcu) {
+        freeNode(pList->arena, node);
+        return;
     }
-    // If curr is not NULL, add before curr.
-    else {
-        newNode->next = pList->curr;
-        newNode->prev = pList->curr->prev;
-        if (pList->curr->prev != NULL) {
-            pList->curr->prev->next = newNode;
-        }
-        else { // curr was at the head
-            pList->head = newNode;
-        }
-        pList->curr->prev = newNode;
+    // Readers follow only next links, and the node's next still leads back into the
+    // list, so prev is the one to chain retired nodes through
+    setNodePrev(node, pList->retired);
+    pList->retired = node;
+    if (++pList->numRetired >= LIST_RCU_RETIRE_BATCH) {
+        List_rcu_reclaim(pList);
     }
-    pList->size++;
-    pList->curr = newNode;
-    return 0;
-
 }
 
-// Adds item to the end of pList, and makes the new item the current one. 
+// Makes room in pList's hash index, if it has one, for count more nodes.
 // Returns 0 on success, -1 on failure.
-int List_append(List* pList, void* pItem){
-    assert(pList != NULL);
+static inline int reserveIndexed(List* pList, int count) {
+    return pList->index != NULL ? ListIndex_reserve(pList->index, count) : 0;
+}
 
-    Node* newNode = allocateNode();
-    if (newNode == NULL) {
-        return -1;
+// Keeps pList's hash index, if it has one, in step with a node being linked in
+static inline void indexNode(List* pList, Node* node) {
+    if (pList->index != NULL) {
+        ListIndex_insert(pList->index, node);
     }
-    newNode->data = pItem;
+}
 
-    if (pList->tail == NULL) { // List is empty
-        pList->head = newNode;
-        pList->tail = newNode;
-    } 
-    else {
-        pList->tail->next = newNode;
-        newNode->prev = pList->tail;
-        pList->tail = newNode;
+// Keeps pList's hash index, if it has one, in step with a node being unlinked
+static inline void unindexNode(List* pList, Node* node) {
+    if (pList->index != NULL) {
+        ListIndex_remove(pList->index, node);
     }
-    pList->size++;
-    pList->curr = newNode;
-    return 0;
 }
 
-// Adds item to the front of pList, and makes the new item the current one. 
-// Returns 0 on success, -1 on failure.
-int List_prepend(List* pList, void* pItem){
-    assert(pList != NULL);
+// Counts a search that compared visited nodes in this thread's histogram
+static inline void recordSearchLength(int visited) {
+    int bucket = visited == 0 ? 0 : 32 - __builtin_clz((unsigned)visited);
+    if (bucket >= LIST_SEARCH_HISTOGRAM_BUCKETS) {
+        bucket = LIST_SEARCH_HISTOGRAM_BUCKETS - 1;
+    }
+    addCount(&currentMagazine()->stats.searchLengths[bucket], 1);
+}
+
+// Counts a List_search that compared visited nodes, in pList and in this thread's histogram
+static inline void recordSearch(List* pList, int visited) {
+    pList->opCounts.searches++;
+    pList->opCounts.searchNodesVisited += visited;
+    recordSearchLength(visited);
+}
 
-    Node* newNode = allocateNode();
+// Takes a node for a new item of pList from its arena, with room for it in the hash
+// index. pItem is referenced, or with inlineItem the arena's payload size in bytes
+// are copied from it into the node (zeroed if pItem is NULL). The caller links the
+// node in. Returns NULL on failure.
+static Node* newItemNode(List* pList, const void* pItem, bool inlineItem) {
+    if (reserveIndexed(pList, 1) != 0) {
+        return NULL;
+    }
+    Node* newNode = allocateNode(pList->arena);
     if (newNode == NULL) {
-        return -1;
+        return NULL;
     }
-    newNode->data = pItem;
-
-    if(pList->tail == NULL){
-        pList->head = newNode;
-        pList->tail = newNode;
+    if (inlineItem) {
+        if (pItem != NULL) {
+            memcpy(nodePayload(newNode), pItem, pList->arena->payloadSize);
+        }
+        else {
+            memset(nodePayload(newNode), 0, pList->arena->payloadSize);
+        }
+        newNode->data = nodePayload(newNode);
     }
     else {
-        newNode->next = pList->head;
-        pList->head->prev = newNode;
-        pList->head = newNode;
-    } 
-    pList->size++;
-    pList->curr = newNode;
-    return 0;
+        newNode->data = (void*)pItem;
+    }
+    indexNode(pList, newNode);
+    pList->opCounts.inserts++;
+    pList->generation++;
+    return newNode;
 }
 
-// Return current item and take it out of pList. Make the next item the current one.
-// If the current pointer is before the start of the pList, or beyond the end of the pList,
-// then do not change the pList and return NULL.
-void* List_remove(List* pList){
-    assert(pList != NULL);
-
-    // Return NULL if before start or beyond end of the list
-    if (pList->curr == NULL) {
-        return NULL;
+// Appends node, holding pItem, to the private chain first..last
+static inline void chainNode(Node** pFirst, Node** pLast, Node* node, void* pItem) {
+    node->data = pItem;
+    setNodePrev(node, *pLast);
+    setNodeNext(node, NULL);
+    if (*pLast != NULL) {
+        setNodeNext(*pLast, node);
+    } else {
+        *pFirst = node;
     }
+    *pLast = node;
+}
 
-    Node* nodeToRemove = pList->curr;
-    void* item = nodeToRemove->data;
-
-    // If it's the only node in the list
-    if (pList->head == pList->tail) {//////////////////
-        pList->head = NULL;
-        pList->tail = NULL;
-        pList->curr = NULL;
+// Allocates count nodes from arena holding pItems[0..count-1], linked to each
+// other in order, and returns the first (with the last in *pLast). For the default
+// arena, takes what this thread's magazine holds first; the rest is popped from
+// the depot under a single lock. All or nothing: returns NULL, with no nodes
+// taken, if the pool runs out.
+static Node* allocateChain(ListArena* arena, void** pItems, int count, Node** pLast) {
+    NodeMagazine* pMagazine = arena == &defaultArena ? currentMagazine() : NULL;
+
+    Node* first = NULL;
+    Node* last = NULL;
+    int linked = 0;
+    for (; pMagazine != NULL && linked < count && pMagazine->count > 0; linked++) {
+        chainNode(&first, &last, Pool_at(&arena->nodePool, pMagazine->indices[--pMagazine->count]), pItems[linked]);
     }
-    // If the node to remove is the head
-    else if (nodeToRemove == pList->head) {
-        pList->head = nodeToRemove->next;
-        if (pList->head != NULL) {
-            pList->head->prev = NULL;
+    if (linked < count) {
+        pthread_mutex_lock(&arena->nodeLock);
+        int nodeIndex;
+        for (; linked < count && (nodeIndex = depotAllocNodeIndex(arena)) >= 0; linked++) {
+            chainNode(&first, &last, Pool_at(&arena->nodePool, nodeIndex), pItems[linked]);
         }
-        pList->curr = pList->head;
+        pthread_mutex_unlock(&arena->nodeLock);
     }
-    // If the node to remove is the tail
-    else if (nodeToRemove == pList->tail) {
-        pList->tail = nodeToRemove->prev;
-        pList->tail->next = NULL;
-        pList->curr = NULL; // Since there's no next node
+    if (pMagazine != NULL) {
+        addCount(&pMagazine->stats.nodeAllocs, linked);
     }
-    // Removing a middle node
-    else {
-        nodeToRemove->prev->next = nodeToRemove->next;
-        nodeToRemove->next->prev = nodeToRemove->prev;
-        pList->curr = nodeToRemove->next;
+
+    if (linked < count) {
+        // Out of memory part way: hand back what we took
+        if (pMagazine != NULL) {
+            addCount(&pMagazine->stats.nodeAllocFailures, 1);
+        }
+        while (first != NULL) {
+            Node* next = nodeNext(first);
+            freeNode(arena, first);
+            first = next;
+        }
+        return NULL;
     }
+    *pLast = last;
+    return first;
+}
 
-    // Update list size and free the node
-    pList->size--;
-    freeNode(nodeToRemove);
-    return item;
+// Gives pList the hash index pIndex, registered with pList's arena
+static void attachIndex(List* pList, ListIndex* pIndex) {
+    ListArena* arena = pList->arena;
+    pthread_mutex_lock(&arena->headLock);
+    ListIndex_link(pIndex, &arena->indexes);
+    pthread_mutex_unlock(&arena->headLock);
+    pList->index = pIndex;
 }
 
+// Frees pList's hash index, if it has one
+static void destroyIndex(List* pList) {
+    if (pList->index == NULL) {
+        return;
+    }
+    ListArena* arena = pList->arena;
+    pthread_mutex_lock(&arena->headLock);
+    ListIndex_unlink(pList->index, &arena->indexes);
+    pthread_mutex_unlock(&arena->headLock);
+    ListIndex_destroy(pList->index);
+    pList->index = NULL;
+}
 
-// Return last item and take it out of pList. Make the new last item the current one.
-// Return NULL if pList is initially empty.
-void* List_trim(List* pList){
-    assert(pList != NULL);
+// Returns a list head to its arena's pool in O(1) time
+static void freeHead(List* pList) {
+    destroyIndex(pList);
+    ListArena* arena = pList->arena;
+    pthread_mutex_lock(&arena->headLock);
+    Pool_free(&arena->listPool, Pool_indexOf(&arena->listPool, pList));
+    pthread_mutex_unlock(&arena->headLock);
+}
+
+// A snapshot file is this header followed by count records of recordSize bytes each
+#define SNAPSHOT_MAGIC "LISTSNAP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BUFFER_BYTES (1 << 20)
+
+typedef struct SnapshotHeader_s SnapshotHeader;
+struct SnapshotHeader_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+};
+
+// Whether a mapped file of fileSize bytes starts with header and holds exactly its records
+static bool snapshotValid(const SnapshotHeader* header, size_t fileSize) {
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != SNAPSHOT_VERSION || header->recordSize == 0) {
+        return false;
+    }
+    size_t recordBytes = fileSize - sizeof(SnapshotHeader);
+    return header->count <= INT32_MAX && recordBytes % header->recordSize == 0
+        && recordBytes / header->recordSize == header->count;
+}
+
+// Takes count nodes from arena for loadRecords, as runs of consecutive nodes: from
+// never-used pool space while there is some, then from nodes released earlier, and
+// only then by growing the pool. A fresh pool therefore gives one run per slab, and
+// loading into a pool that has been used does not make it grow needlessly.
+// Stores the runs in *pRunFirst and *pRunLength (freed by the caller) and returns
+// how many there are, or -1, with nothing taken, if the pool runs out.
+static int takeNodeRuns(ListArena* arena, int count, int** pRunFirst, int** pRunLength) {
+    Pool* pool = &arena->nodePool;
+    int capacity = count / POOL_SLAB_SIZE + 2;
+    int* runFirst = malloc(capacity * sizeof(int));
+    int* runLength = malloc(capacity * sizeof(int));
+    int numRuns = 0;
+    int taken = 0;
+
+    pthread_mutex_lock(&arena->nodeLock);
+    while (taken < count && runFirst != NULL && runLength != NULL) {
+        if (numRuns == capacity) {
+            capacity *= 2;
+            int* first = realloc(runFirst, capacity * sizeof(int));
+            runFirst = first != NULL ? first : runFirst;
+            int* length = realloc(runLength, capacity * sizeof(int));
+            runLength = length != NULL ? length : runLength;
+            if (first == NULL || length == NULL) {
+                break;
+            }
+        }
+        int length;
+        if (pool->bump == Pool_capacity(pool) && (arena->freeChain != NULL || pool->freeTop >= 0)) {
+            runFirst[numRuns] = depotAllocNodeIndex(arena);
+            length = 1;
+        }
+        else if ((length = Pool_allocRun(pool, count - taken, &runFirst[numRuns])) < 0) {
+            break;
+        }
+        runLength[numRuns++] = length;
+        taken += length;
+    }
+    if (taken < count) {
+        // Out of memory: hand back what we took
+        for (int run = 0; run < numRuns; run++) {
+            for (int i = 0; i < runLength[run]; i++) {
+                Pool_free(pool, runFirst[run] + i);
+            }
+        }
+    }
+    pthread_mutex_unlock(&arena->nodeLock);
+
+    if (taken < count) {
+        free(runFirst);
+        free(runLength);
+        return -1;
+    }
+    *pRunFirst = runFirst;
+    *pRunLength = runLength;
+    return numRuns;
+}
+
+// Fills the empty list pList with count items made from the records at pRecords.
+// Every node is taken before any item is made, so running out of nodes leaves
+// nothing behind. Returns 0 on success, -1 on failure.
+static int loadRecords(List* pList, const char* pRecords, size_t recordSize, int count, DESERIALIZE_FN pDeserialize) {
+    ListArena* arena = pList->arena;
+    NodeMagazine* pMagazine = arena == &defaultArena ? currentMagazine() : NULL;
+    int* runFirst;
+    int* runLength;
+    int numRuns = takeNodeRuns(arena, count, &runFirst, &runLength);
+    if (numRuns < 0) {
+        if (pMagazine != NULL) {
+            addCount(&pMagazine->stats.nodeAllocFailures, 1);
+        }
+        return -1;
+    }
+    if (pMagazine != NULL) {
+        addCount(&pMagazine->stats.nodeAllocs, count);
+    }
+
+    Node* first = NULL;
+    Node* last = NULL;
+    for (int run = 0; run < numRuns; run++) {
+        char* node = Pool_at(&arena->nodePool, runFirst[run]);
+        for (int i = 0; i < runLength[run]; i++, node += arena->nodePool.stride, pRecords += recordSize) {
+            void* pItem;
+            if (pDeserialize != NULL) {
+                pItem = pDeserialize(pRecords);
+            }
+            else {
+                pItem = nodePayload((Node*)node);
+                memcpy(pItem, pRecords, recordSize);
+            }
+            chainNode(&first, &last, (Node*)node, pItem);
+        }
+    }
+    free(runFirst);
+    free(runLength);
+
+    setListHead(pList, first);
+    pList->tail = last;
+    pList->curr = last;
+    pList->size = count;
+    pList->currIndex = count - 1;
+    pList->opCounts.inserts += count;
+    pList->generation++;
+    return 0;
+}
+
+//######################################################################################################################
+//######################################################################################################################
+
+// Makes a new, empty list, and returns its reference on success. 
+// Returns a NULL pointer on failure.
+List* List_create(){
+
+    //Initialize the node pool
+    initializePoolsIfNeeded();
+    // Initialize the list head pool if it hasn't been initialized yet
+    initializeHeadPoolsIfNeeded();
+
+    return List_create_in(&defaultArena);
+}
+
+// Makes a new, empty list whose head and nodes come from arena.
+// Returns a NULL pointer on failure.
+List* List_create_in(ListArena* arena){
+    assert(arena != NULL);
+
+    // Pop a list head index off the stack of free list heads
+    pthread_mutex_lock(&arena->headLock);
+    int listIndex = Pool_alloc(&arena->listPool);
+    pthread_mutex_unlock(&arena->headLock);
+    if (listIndex < 0) {
+        return NULL; // No free list heads available
+    }
+
+    // After ListArena_reset heads are handed out again as they were left, so set every field
+    List* pList = Pool_at(&arena->listPool, listIndex);
+    // The generation carries on from the head's last list, so that a compactor left on that
+    // one does not take this list for it
+    *pList = (List){ .currIndexKnown = true, .arena = arena, .generation = pList->generation + 1 };
+    return pList;
+}
+
+// Makes an arena whose nodes each carry payloadSize bytes of item storage.
+static ListArena* createArena(size_t payloadSize) {
+#ifdef LIST_COMPACT_LINKS
+    // Compact links are decoded with the default node pool's geometry, which a
+    // larger node stride would break
+    if (payloadSize > 0) {
+        return NULL;
+    }
+#endif
+    initializePoolsIfNeeded();
+
+    ListArena* arena = malloc(sizeof(ListArena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    size_t padded = (payloadSize + INLINE_PAYLOAD_ALIGN - 1) & ~(size_t)(INLINE_PAYLOAD_ALIGN - 1);
+    Pool_initShared(&arena->nodePool, sizeof(Node) + padded, &nodeDirectory);
+    Pool_initShared(&arena->listPool, sizeof(List), &headDirectory);
+    pthread_mutex_init(&arena->nodeLock, NULL);
+    pthread_mutex_init(&arena->headLock, NULL);
+    arena->freeChain = NULL;
+    arena->freeChainLength = 0;
+    arena->indexes = NULL;
+    arena->payloadSize = payloadSize;
+    arena->file = NULL;
+    return arena;
+}
+
+// Makes a new arena with empty node and head pools, and returns its reference on success.
+// Returns a NULL pointer on failure.
+ListArena* ListArena_create(){
+    return createArena(0);
+}
+
+// Makes a new arena whose nodes can hold items of up to payloadSize bytes inline.
+// Returns a NULL pointer on failure.
+ListArena* ListArena_create_inline(size_t payloadSize){
+    assert(payloadSize > 0);
+
+    return createArena(payloadSize);
+}
+
+// Process-wide inline arenas for ListArena_shared_inline, one per payload size
+typedef struct SharedInlineArena_s SharedInlineArena;
+struct SharedInlineArena_s {
+    ListArena* arena;
+    SharedInlineArena* next;
+};
+static SharedInlineArena* sharedInlineArenas = NULL;
+static pthread_mutex_t sharedInlineLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Returns the process-wide inline arena for payloadSize, making it on first use.
+// Returns a NULL pointer on failure.
+ListArena* ListArena_shared_inline(size_t payloadSize){
+    assert(payloadSize > 0);
+
+    pthread_mutex_lock(&sharedInlineLock);
+    SharedInlineArena* shared = sharedInlineArenas;
+    while (shared != NULL && shared->arena->payloadSize != payloadSize) {
+        shared = shared->next;
+    }
+    if (shared == NULL) {
+        shared = malloc(sizeof(SharedInlineArena));
+        if (shared != NULL) {
+            shared->arena = createArena(payloadSize);
+            if (shared->arena != NULL) {
+                shared->next = sharedInlineArenas;
+                sharedInlineArenas = shared;
+            }
+            else {
+                free(shared);
+                shared = NULL;
+            }
+        }
+    }
+    pthread_mutex_unlock(&sharedInlineLock);
+    return shared != NULL ? shared->arena : NULL;
+}
+
+// Frees the hash indexes of all of arena's lists
+static void destroyArenaIndexes(ListArena* arena) {
+    pthread_mutex_lock(&arena->headLock);
+    while (arena->indexes != NULL) {
+        ListIndex* pIndex = arena->indexes;
+        ListIndex_unlink(pIndex, &arena->indexes);
+        ListIndex_destroy(pIndex);
+    }
+    pthread_mutex_unlock(&arena->headLock);
+}
+
+// Releases every list in arena, and all their nodes, at once.
+void ListArena_reset(ListArena* arena){
+    assert(arena != NULL && arena != &defaultArena);
+
+    destroyArenaIndexes(arena);
+    pthread_mutex_lock(&arena->headLock);
+    Pool_reset(&arena->listPool);
+    pthread_mutex_unlock(&arena->headLock);
+
+    pthread_mutex_lock(&arena->nodeLock);
+    Pool_reset(&arena->nodePool);
+    arena->freeChain = NULL;
+    arena->freeChainLength = 0;
+    pthread_mutex_unlock(&arena->nodeLock);
+}
+
+// Releases every list in arena and returns the arena's memory to the system.
+void ListArena_destroy(ListArena* arena){
+    assert(arena != NULL && arena != &defaultArena && arena->file == NULL);
+
+    destroyArenaIndexes(arena);
+    Pool_destroy(&arena->listPool);
+    Pool_destroy(&arena->nodePool);
+    pthread_mutex_destroy(&arena->nodeLock);
+    pthread_mutex_destroy(&arena->headLock);
+    free(arena);
+}
+
+// Works out where everything goes in an arena file with the given number of slabs
+static ArenaFileLayout arenaFileLayout(size_t nodeStride, int nodeSlabs, int headSlabs) {
+    size_t nodeSlabBytes = Pool_slabBytesFor(nodeStride);
+    size_t headSlabBytes = Pool_slabBytesFor(sizeof(List));
+    ArenaFileLayout layout;
+    layout.nodeSlabNumbers = sizeof(ArenaFile);
+    layout.headSlabNumbers = layout.nodeSlabNumbers + nodeSlabs * sizeof(int);
+    layout.nodeFreeStack = layout.headSlabNumbers + headSlabs * sizeof(int);
+    layout.headFreeStack = layout.nodeFreeStack + ((size_t)nodeSlabs << POOL_SLAB_SHIFT) * sizeof(int);
+    size_t end = layout.headFreeStack + ((size_t)headSlabs << POOL_SLAB_SHIFT) * sizeof(int);
+    layout.nodeSlabs = (end + nodeSlabBytes - 1) & ~(nodeSlabBytes - 1);
+    end = layout.nodeSlabs + nodeSlabs * nodeSlabBytes;
+    layout.headSlabs = (end + headSlabBytes - 1) & ~(headSlabBytes - 1);
+    layout.fileSize = layout.headSlabs + headSlabs * headSlabBytes;
+    layout.alignment = nodeSlabBytes > headSlabBytes ? nodeSlabBytes : headSlabBytes;
+    return layout;
+}
+
+// Maps a new arena file of layout.fileSize bytes at an address aligned to layout.alignment.
+// Returns the mapping, or NULL on failure.
+static char* mapNewArenaFile(int fd, ArenaFileLayout layout) {
+    // Reserve enough address space to align within, then map the file over part of it
+    size_t reserved = layout.fileSize + layout.alignment;
+    char* raw = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    char* base = (char*)(((uintptr_t)raw + layout.alignment - 1) & ~(uintptr_t)(layout.alignment - 1));
+    if (mmap(base, layout.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(raw, reserved);
+        return NULL;
+    }
+    if (base > raw) {
+        munmap(raw, base - raw);
+    }
+    munmap(base + layout.fileSize, raw + reserved - (base + layout.fileSize));
+    return base;
+}
+
+// Sets up a new arena in the freshly mapped, zeroed file at base. Returns 0 on success.
+static int initArenaFile(ArenaFile* file, size_t payloadSize, size_t nodeStride, int nodeSlabs, int headSlabs) {
+    ArenaFileLayout layout = arenaFileLayout(nodeStride, nodeSlabs, headSlabs);
+    char* base = (char*)file;
+    memcpy(file->magic, ARENA_FILE_MAGIC, sizeof(file->magic));
+    file->version = ARENA_FILE_VERSION;
+    file->nodeSize = sizeof(Node);
+    file->listSize = sizeof(List);
+    file->fileSize = layout.fileSize;
+    file->base = (uintptr_t)base;
+    file->nodeSlabs = nodeSlabs;
+    file->headSlabs = headSlabs;
+
+    ListArena* arena = &file->arena;
+    if (Pool_initFixed(&arena->nodePool, nodeStride, &nodeDirectory, base + layout.nodeSlabs, nodeSlabs,
+            (int*)(base + layout.nodeSlabNumbers), (int*)(base + layout.nodeFreeStack)) != 0) {
+        return -1;
+    }
+    if (Pool_initFixed(&arena->listPool, sizeof(List), &headDirectory, base + layout.headSlabs, headSlabs,
+            (int*)(base + layout.headSlabNumbers), (int*)(base + layout.headFreeStack)) != 0) {
+        Pool_detach(&arena->nodePool);
+        return -1;
+    }
+    arena->payloadSize = payloadSize;
+    arena->file = file;
+    return 0;
+}
+
+// Whether the list pList, found in file, is well formed: its head and nodes lie in
+// the file's pools, its links agree in both directions and its size is right
+static bool persistentListValid(ArenaFile* file, List* pList) {
+    ListArena* arena = &file->arena;
+    char* heads = arena->listPool.fixedMemory;
+    if ((char*)pList < heads || (char*)pList >= heads + (size_t)file->headSlabs * arena->listPool.slabBytes
+        || pList->arena != arena || pList->index != NULL) {
+        return false;
+    }
+    char* nodes = arena->nodePool.fixedMemory;
+    char* nodesEnd = nodes + (size_t)file->nodeSlabs * arena->nodePool.slabBytes;
+    Node* previous = NULL;
+    int count = 0;
+    for (Node* node = pList->head; node != NULL; node = nodeNext(node)) {
+        if ((char*)node < nodes || (char*)node >= nodesEnd || nodePrev(node) != previous || count == pList->size) {
+            return false;
+        }
+        previous = node;
+        count++;
+    }
+    return count == pList->size && pList->tail == previous;
+}
+
+// Maps an existing arena file and takes it up again. Returns the arena, or NULL if
+// the file is not a usable arena file or cannot go back at its old address.
+static ListArena* reopenArenaFile(int fd, size_t fileSize, size_t payloadSize) {
+    ArenaFile header;
+    if (fileSize < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)
+        || memcmp(header.magic, ARENA_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != ARENA_FILE_VERSION || header.nodeSize != sizeof(Node)
+        || header.listSize != sizeof(List) || header.fileSize != fileSize
+        || header.arena.payloadSize != payloadSize) {
+        return NULL;
+    }
+
+    void* wanted = (void*)header.base;
+    char* base = mmap(wanted, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    if (base != wanted) {
+        munmap(base, fileSize); // Something else already lives at the old address
+        return NULL;
+    }
+
+    ArenaFile* file = (ArenaFile*)base;
+    ListArena* arena = &file->arena;
+    if (Pool_reattach(&arena->nodePool, &nodeDirectory) != 0) {
+        munmap(base, fileSize);
+        return NULL;
+    }
+    if (Pool_reattach(&arena->listPool, &headDirectory) != 0) {
+        Pool_detach(&arena->nodePool);
+        munmap(base, fileSize);
+        return NULL;
+    }
+
+    // After a crash, check every root list before trusting the file
+    if (file->dirty) {
+        for (int i = 0; i < LIST_ARENA_ROOTS; i++) {
+            if (file->roots[i] != NULL && !persistentListValid(file, file->roots[i])) {
+                Pool_detach(&arena->listPool);
+                Pool_detach(&arena->nodePool);
+                munmap(base, fileSize);
+                return NULL;
+            }
+        }
+    }
+    return arena;
+}
+
+// Opens the persistent arena in the file at path, making the file if it does not exist.
+// Returns a NULL pointer on failure.
+ListArena* ListArena_open(const char* path, size_t payloadSize, int maxNodes, int maxLists){
+    assert(path != NULL && payloadSize > 0 && maxNodes > 0 && maxLists > 0);
+#ifdef LIST_COMPACT_LINKS
+    return NULL; // Items must be inline, which compact links do not allow
+#endif
+    initializePoolsIfNeeded();
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    ListArena* arena = NULL;
+    if (st.st_size > 0) {
+        arena = reopenArenaFile(fd, st.st_size, payloadSize);
+    }
+    else {
+        size_t padded = (payloadSize + INLINE_PAYLOAD_ALIGN - 1) & ~(size_t)(INLINE_PAYLOAD_ALIGN - 1);
+        size_t nodeStride = sizeof(Node) + padded;
+        int nodeSlabs = (maxNodes + POOL_SLAB_SIZE - 1) / POOL_SLAB_SIZE;
+        int headSlabs = (maxLists + POOL_SLAB_SIZE - 1) / POOL_SLAB_SIZE;
+        ArenaFileLayout layout = arenaFileLayout(nodeStride, nodeSlabs, headSlabs);
+        char* base = ftruncate(fd, layout.fileSize) == 0 ? mapNewArenaFile(fd, layout) : NULL;
+        if (base != NULL && initArenaFile((ArenaFile*)base, payloadSize, nodeStride, nodeSlabs, headSlabs) == 0) {
+            arena = &((ArenaFile*)base)->arena;
+        }
+        else {
+            if (base != NULL) {
+                munmap(base, layout.fileSize);
+            }
+            ftruncate(fd, 0); // Leave no half-made arena behind
+        }
+    }
+    close(fd); // The mapping stays valid without the descriptor
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    // Locks left in the file by an earlier process mean nothing now
+    pthread_mutex_init(&arena->nodeLock, NULL);
+    pthread_mutex_init(&arena->headLock, NULL);
+    arena->file->dirty = 1;
+    return arena;
+}
+
+// Writes arena's file out to disk. Returns 0 on success, -1 on failure.
+int ListArena_sync(ListArena* arena){
+    assert(arena != NULL && arena->file != NULL);
+
+    return msync(arena->file, arena->file->fileSize, MS_SYNC) == 0 ? 0 : -1;
+}
+
+// Writes arena's file out to disk and unmaps it. Its lists can be had back by opening it again.
+void ListArena_close(ListArena* arena){
+    assert(arena != NULL && arena->file != NULL);
+
+    ArenaFile* file = arena->file;
+    file->dirty = 0;
+    ListArena_sync(arena);
+    Pool_detach(&arena->listPool);
+    Pool_detach(&arena->nodePool);
+    pthread_mutex_destroy(&arena->nodeLock);
+    pthread_mutex_destroy(&arena->headLock);
+    munmap(file, file->fileSize);
+}
+
+// Records pList (or NULL) as root slot of arena, so that it can be found after reopening.
+void ListArena_set_root(ListArena* arena, int slot, List* pList){
+    assert(arena != NULL && arena->file != NULL && slot >= 0 && slot < LIST_ARENA_ROOTS);
+    assert(pList == NULL || pList->arena == arena);
+
+    arena->file->roots[slot] = pList;
+}
+
+// Returns the list recorded as root slot of arena, or NULL if there is none.
+List* ListArena_get_root(ListArena* arena, int slot){
+    assert(arena != NULL && arena->file != NULL && slot >= 0 && slot < LIST_ARENA_ROOTS);
+
+    return arena->file->roots[slot];
+}
+
+// Returns the number of items in pList.
+int List_count(List* pList){
+    return pList->size;
+}
+
+// Returns a pointer to the first item in pList and makes the first item the current item.
+// Returns NULL and sets current item to NULL if list is empty.
+void* List_first(List* pList){
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->curr = pList->head;//sets the first item the current item
+    pList->currIndex = 0;
+    pList->currIndexKnown = true;
+    if (pList->curr == NULL) {
+        return NULL;
+    }
+    return pList->curr->data;// void pointer to the item
+}
+
+// Returns a pointer to the last item in pList and makes the last item the current item.
+// Returns NULL and sets current item to NULL if list is empty.
+void* List_last(List* pList){
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->curr = pList->tail;//sets the last item the current item
+    pList->currIndex = pList->size - 1;
+    pList->currIndexKnown = true;
+    if (pList->curr == NULL) {
+        return NULL;
+    }
+    return pList->curr->data;// void pointer to the item
+}
+
+// Advances pList's current item by one, and returns a pointer to the new current item.
+// If this operation advances the current item beyond the end of the pList, a NULL pointer 
+// is returned and the current item is set to be beyond end of pList.
+void* List_next(List* pList){
+
+    assert(pList != NULL);
+
+    // Check if the list is empty or if we are already out of bounds at the end
+    if (pList->curr == NULL || pList->oob_end) {
+        // already at the end and trying to move forward, set the flag
+        pList->oob_end = true;
+        return NULL;
+    }
+
+    // Move the current pointer forward
+    pList->curr = nodeNext(pList->curr);
+    pList->currIndex++;
+   
+    // Check if we have moved out of bounds at the end
+    if (pList->curr == NULL) {
+        pList->oob_end = true;
+        return NULL;
+    }
+
+    // successfully moved forward, reset out-of-bounds flags
+    pList->oob_end = false;
+    prefetchNode(nodeNext(pList->curr));
+    return pList->curr->data;
+}
+
+// Backs up pList's current item by one, and returns a pointer to the new current item. 
+// If this operation backs up the current item beyond the start of the pList, a NULL pointer 
+// is returned and the current item is set to be before the start of pList.
+void* List_prev(List* pList){
+
+    assert(pList != NULL);
+
+    // Check if the list is empty or if we are already out of bounds at the start
+    if (pList->curr == NULL || pList->oob_start) {
+        // already at the start and trying to move back, set the flag
+        pList->oob_start = true;
+        return NULL;
+    }
+
+    // Move the current pointer back
+    pList->curr = nodePrev(pList->curr);
+    pList->currIndex--;
+    
+    // Check if we have moved out of bounds at the start
+    if (pList->curr == NULL) {
+        pList->oob_start = true;
+        return NULL;
+    }
+
+    // successfully moved back, reset out-of-bounds flags
+    pList->oob_start = false;
+    prefetchNode(nodePrev(pList->curr));
+    return pList->curr->data;
+}
+
+// Returns a pointer to the current item in pList.
+void* List_curr(List* pList){
+    assert(pList != NULL);
+
+    return pList->curr->data;
+}
+
+// Makes the item at position index (0 is the first item) the current item and returns it.
+// Walks from whichever of the head, the tail and the current item is nearest.
+// An index below 0 leaves the current item before the start of pList, and an index of
+// List_count or more leaves it beyond the end; both return NULL.
+void* List_seek(List* pList, int index){
+    assert(pList != NULL);
+
+    if (index < 0 || index >= pList->size) {
+        pList->curr = NULL;
+        pList->oob_start = index < 0;
+        pList->oob_end = index >= 0;
+        return NULL;
+    }
+
+    // Pick the cheapest starting point
+    Node* node = pList->head;
+    int position = 0;
+    int distance = index;
+    if (pList->size - 1 - index < distance) {
+        node = pList->tail;
+        position = pList->size - 1;
+        distance = pList->size - 1 - index;
+    }
+    if (pList->curr != NULL && pList->currIndexKnown && abs(index - pList->currIndex) < distance) {
+        node = pList->curr;
+        position = pList->currIndex;
+    }
+
+    for (; position < index; position++) {
+        node = nodeNext(node);
+    }
+    for (; position > index; position--) {
+        node = nodePrev(node);
+    }
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->curr = node;
+    pList->currIndex = index;
+    pList->currIndexKnown = true;
+    return node->data;
+}
+
+// Returns the position of the current item in pList (0 is the first item),
+// or -1 if the current item is before the start or beyond the end.
+int List_index_of_curr(List* pList){
+    assert(pList != NULL);
+
+    if (pList->curr == NULL) {
+        return -1;
+    }
+    // After List_find_key the position is found lazily, by counting back to the head
+    if (!pList->currIndexKnown) {
+        int index = 0;
+        for (Node* node = nodePrev(pList->curr); node != NULL; node = nodePrev(node)) {
+            index++;
+        }
+        pList->currIndex = index;
+        pList->currIndexKnown = true;
+    }
+    return pList->currIndex;
+}
+
+// Links newNode into pList directly after the current item, for the List_insert_after calls.
+// Returns 0 on success, or -1 if newNode is NULL because its allocation failed.
+static int insertNodeAfter(List* pList, Node* newNode) {
+    if (newNode == NULL) {
+        return -1; // Allocation failed
+    }
+
+    // If the list is empty, add to the start, which is also the end.
+    if (pList->head == NULL) {
+        setListHead(pList, newNode);
+        pList->tail = newNode;
+        pList->curr = newNode; // Set current to the new node
+        pList->currIndex = 0;
+        pList->currIndexKnown = true;
+    }
+    // If curr is beyond the end, add to the end.
+    else if (pList->curr == NULL || pList->oob_end) {
+        setNodeNext(pList->tail, newNode);
+        setNodePrev(newNode, pList->tail);
+        pList->tail = newNode;
+        pList->curr = newNode; // Set current to the new node
+        pList->currIndex = pList->size;
+        pList->currIndexKnown = true;
+    }
+    // If curr is not NULL, add after curr.
+    else {
+        setNodeNext(newNode, nodeNext(pList->curr));
+        setNodePrev(newNode, pList->curr);
+        if (nodeNext(pList->curr) == NULL) { // curr was at the end
+            pList->tail = newNode;
+        } else { // curr was not at the end
+            setNodePrev(nodeNext(pList->curr), newNode);
+        }
+        setNodeNext(pList->curr, newNode);
+        pList->curr = newNode; // set current to new node
+        pList->currIndex++;
+    }
+
+    pList->size++;
+    return 0;
+
+}
+
+// Adds the new item to pList directly after the current item, and makes item the current item. 
+// If the current pointer is before the start of the pList, the item is added at the start. If 
+// the current pointer is beyond the end of the pList, the item is added at the end. 
+// Returns 0 on success, -1 on failure.
+int List_insert_after(List* pList, void* pItem){
+    assert(pList != NULL);
+
+    return insertNodeAfter(pList, newItemNode(pList, pItem, false));
+}
+
+// Copies an item into a new node directly after the current item, as List_insert_after.
+// Returns 0 on success, -1 on failure.
+int List_insert_after_copy(List* pList, const void* pPayload){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
+
+    return insertNodeAfter(pList, newItemNode(pList, pPayload, true));
+}
+
+// Links newNode into pList directly before the current item, for the List_insert_before calls.
+// Returns 0 on success, or -1 if newNode is NULL because its allocation failed.
+static int insertNodeBefore(List* pList, Node* newNode) {
+    if (newNode == NULL) {
+        return -1;
+    }
+
+    // If the list is empty, add to start.
+    if (pList->head == NULL) {
+        setListHead(pList, newNode);
+        pList->tail = newNode;
+        pList->currIndex = 0;
+        pList->currIndexKnown = true;
+    }
+    // If curr is before the start, add to start.
+    else if (pList->curr == NULL || pList->oob_start) {
+        setNodeNext(newNode, pList->head);
+        setNodePrev(pList->head, newNode);
+        setListHead(pList, newNode);
+        pList->currIndex = 0;
+        pList->currIndexKnown = true;
+    }
+    // If curr is not NULL, add before curr.
+    else {
+        setNodeNext(newNode, pList->curr);
+        setNodePrev(newNode, nodePrev(pList->curr));
+        if (nodePrev(pList->curr) != NULL) {
+            setNodeNext(nodePrev(pList->curr), newNode);
+        }
+        else { // curr was at the head
+            setListHead(pList, newNode);
+        }
+        setNodePrev(pList->curr, newNode);
+    }
+    pList->size++;
+    pList->curr = newNode;
+    return 0;
+
+}
+
+// Adds item to pList directly before the current item, and makes the new item the current one. 
+// If the current pointer is before the start of the pList, the item is added at the start. 
+// If the current pointer is beyond the end of the pList, the item is added at the end. 
+// Returns 0 on success, -1 on failure.
+int List_insert_before(List* pList, void* pItem){
+    assert(pList != NULL);
+
+    return insertNodeBefore(pList, newItemNode(pList, pItem, false));
+}
+
+// Copies an item into a new node directly before the current item, as List_insert_before.
+// Returns 0 on success, -1 on failure.
+int List_insert_before_copy(List* pList, const void* pPayload){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
+
+    return insertNodeBefore(pList, newItemNode(pList, pPayload, true));
+}
+
+// Links newNode onto the end of pList, for the List_append calls.
+// Returns 0 on success, or -1 if newNode is NULL because its allocation failed.
+static int appendNode(List* pList, Node* newNode) {
+    if (newNode == NULL) {
+        return -1;
+    }
+
+    if (pList->tail == NULL) { // List is empty
+        setListHead(pList, newNode);
+        pList->tail = newNode;
+    } 
+    else {
+        setNodeNext(pList->tail, newNode);
+        setNodePrev(newNode, pList->tail);
+        pList->tail = newNode;
+    }
+    pList->size++;
+    pList->curr = newNode;
+    pList->currIndex = pList->size - 1;
+    pList->currIndexKnown = true;
+    return 0;
+}
+
+// Adds item to the end of pList, and makes the new item the current one. 
+// Returns 0 on success, -1 on failure.
+int List_append(List* pList, void* pItem){
+    assert(pList != NULL);
+
+    return appendNode(pList, newItemNode(pList, pItem, false));
+}
+
+// Copies an item into a new node at the end of pList, and makes it the current one.
+// Returns 0 on success, -1 on failure.
+int List_append_copy(List* pList, const void* pPayload){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
+
+    return appendNode(pList, newItemNode(pList, pPayload, true));
+}
+
+// Adds count items from pItems to the end of pList, in order, and makes the last of them
+// the current one. All the nodes are taken from the pool up front, so either every
+// item is added or none is.
+// Returns 0 on success, -1 on failure.
+int List_append_n(List* pList, void** pItems, int count){
+    assert(pList != NULL && count >= 0);
+
+    if (count == 0) {
+        return 0;
+    }
+    if (reserveIndexed(pList, count) != 0) {
+        return -1;
+    }
+    Node* last;
+    Node* first = allocateChain(pList->arena, pItems, count, &last);
+    if (first == NULL) {
+        return -1;
+    }
+    if (pList->index != NULL) {
+        for (Node* node = first; node != NULL; node = nodeNext(node)) {
+            ListIndex_insert(pList->index, node);
+        }
+    }
+    pList->opCounts.inserts += count;
+    pList->generation++;
+
+    if (pList->tail == NULL) { // List is empty
+        setListHead(pList, first);
+    }
+    else {
+        setNodeNext(pList->tail, first);
+        setNodePrev(first, pList->tail);
+    }
+    pList->tail = last;
+    pList->size += count;
+    pList->curr = last;
+    pList->currIndex = pList->size - 1;
+    pList->currIndexKnown = true;
+    return 0;
+}
+
+// Adds count items from pItems directly after the current item, in order, and makes
+// the last of them the current one. Where the items go when the current pointer is
+// out of bounds follows List_insert_after. Either every item is added or none is.
+// Returns 0 on success, -1 on failure.
+int List_insert_after_n(List* pList, void** pItems, int count){
+    assert(pList != NULL && count >= 0);
+
+    if (count == 0) {
+        return 0;
+    }
+    if (reserveIndexed(pList, count) != 0) {
+        return -1;
+    }
+    Node* last;
+    Node* first = allocateChain(pList->arena, pItems, count, &last);
+    if (first == NULL) {
+        return -1;
+    }
+    if (pList->index != NULL) {
+        for (Node* node = first; node != NULL; node = nodeNext(node)) {
+            ListIndex_insert(pList->index, node);
+        }
+    }
+    pList->opCounts.inserts += count;
+    pList->generation++;
+
+    // If the list is empty, the chain is the whole list.
+    if (pList->head == NULL) {
+        setListHead(pList, first);
+        pList->tail = last;
+        pList->currIndex = count - 1;
+        pList->currIndexKnown = true;
+    }
+    // If curr is beyond the end, add to the end.
+    else if (pList->curr == NULL || pList->oob_end) {
+        setNodeNext(pList->tail, first);
+        setNodePrev(first, pList->tail);
+        pList->tail = last;
+        pList->currIndex = pList->size + count - 1;
+        pList->currIndexKnown = true;
+    }
+    // If curr is not NULL, splice the chain in after curr.
+    else {
+        Node* after = nodeNext(pList->curr);
+        setNodeNext(last, after);
+        setNodePrev(first, pList->curr);
+        if (after == NULL) { // curr was at the end
+            pList->tail = last;
+        } else {
+            setNodePrev(after, last);
+        }
+        setNodeNext(pList->curr, first);
+        pList->currIndex += count;
+    }
+
+    pList->size += count;
+    pList->curr = last;
+    return 0;
+}
+
+// Links newNode onto the front of pList, for the List_prepend calls.
+// Returns 0 on success, or -1 if newNode is NULL because its allocation failed.
+static int prependNode(List* pList, Node* newNode) {
+    if (newNode == NULL) {
+        return -1;
+    }
+
+    if(pList->tail == NULL){
+        setListHead(pList, newNode);
+        pList->tail = newNode;
+    }
+    else {
+        setNodeNext(newNode, pList->head);
+        setNodePrev(pList->head, newNode);
+        setListHead(pList, newNode);
+    } 
+    pList->size++;
+    pList->curr = newNode;
+    pList->currIndex = 0;
+    pList->currIndexKnown = true;
+    return 0;
+}
+
+// Adds item to the front of pList, and makes the new item the current one. 
+// Returns 0 on success, -1 on failure.
+int List_prepend(List* pList, void* pItem){
+    assert(pList != NULL);
+
+    return prependNode(pList, newItemNode(pList, pItem, false));
+}
+
+// Copies an item into a new node at the front of pList, and makes it the current one.
+// Returns 0 on success, -1 on failure.
+int List_prepend_copy(List* pList, const void* pPayload){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
+
+    return prependNode(pList, newItemNode(pList, pPayload, true));
+}
+
+// Return current item and take it out of pList. Make the next item the current one.
+// If the current pointer is before the start of the pList, or beyond the end of the pList,
+// then do not change the pList and return NULL.
+void* List_remove(List* pList){
+    assert(pList != NULL);
+
+    // Return NULL if before start or beyond end of the list
+    if (pList->curr == NULL) {
+        return NULL;
+    }
+
+    Node* nodeToRemove = pList->curr;
+    void* item = nodeToRemove->data;
+
+    // If it's the only node in the list
+    if (pList->head == pList->tail) {//////////////////
+        setListHead(pList, NULL);
+        pList->tail = NULL;
+        pList->curr = NULL;
+    }
+    // If the node to remove is the head
+    else if (nodeToRemove == pList->head) {
+        setListHead(pList, nodeNext(nodeToRemove));
+        if (pList->head != NULL) {
+            setNodePrev(pList->head, NULL);
+        }
+        pList->curr = pList->head;
+    }
+    // If the node to remove is the tail
+    else if (nodeToRemove == pList->tail) {
+        pList->tail = nodePrev(nodeToRemove);
+        setNodeNext(pList->tail, NULL);
+        pList->curr = NULL; // Since there's no next node
+    }
+    // Removing a middle node
+    else {
+        setNodeNext(nodePrev(nodeToRemove), nodeNext(nodeToRemove));
+        setNodePrev(nodeNext(nodeToRemove), nodePrev(nodeToRemove));
+        pList->curr = nodeNext(nodeToRemove);
+    }
+
+    // Update list size and free the node
+    pList->size--;
+    unindexNode(pList, nodeToRemove);
+    pList->opCounts.removes++;
+    pList->generation++;
+    releaseNode(pList, nodeToRemove);
+    return item;
+}
+
+
+// Return last item and take it out of pList. Make the new last item the current one.
+// Return NULL if pList is initially empty.
+void* List_trim(List* pList){
+    assert(pList != NULL);
+
+    if (pList->tail == NULL) {
+        return NULL;
+    }
+    Node* nodeToRemove = pList->tail;
+    void* item = nodeToRemove->data;
+
+    pList->tail = nodePrev(nodeToRemove);
+    if (pList->tail != NULL) {
+        setNodeNext(pList->tail, NULL);
+    } else {
+        // The list is now empty
+        setListHead(pList, NULL);
+    }
+
+    pList->size--;
+    if (pList->curr == nodeToRemove) {
+        pList->curr = pList->tail;
+        pList->currIndex = pList->size - 1;
+        pList->currIndexKnown = true;
+    }
+
+    unindexNode(pList, nodeToRemove);
+    pList->opCounts.removes++;
+    pList->generation++;
+    releaseNode(pList, nodeToRemove);
+    return item;
+}
+
+// Copies the current item's payload into pOut (if it is not NULL) and takes the item out
+// of pList, as List_remove does. Returns 0 on success, or -1 if there is no current item.
+int List_remove_copy(List* pList, void* pOut){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
+
+    if (pList->curr == NULL) {
+        return -1;
+    }
+    if (pOut != NULL) {
+        memcpy(pOut, pList->curr->data, pList->arena->payloadSize);
+    }
+    List_remove(pList);
+    return 0;
+}
+
+// Copies the last item's payload into pOut (if it is not NULL) and takes the item out
+// of pList, as List_trim does. Returns 0 on success, or -1 if pList is empty.
+int List_trim_copy(List* pList, void* pOut){
+    assert(pList != NULL && pList->arena->payloadSize > 0);
 
     if (pList->tail == NULL) {
+        return -1;
+    }
+    if (pOut != NULL) {
+        memcpy(pOut, pList->tail->data, pList->arena->payloadSize);
+    }
+    List_trim(pList);
+    return 0;
+}
+
+// Moves the current item to the front of pList, relinking its node in O(1) time.
+int List_move_to_front(List* pList){
+    assert(pList != NULL);
+
+    Node* node = pList->curr;
+    if (node == NULL || pList->rcu) {
+        return LIST_FAIL;
+    }
+    if (node != pList->head) {
+        // Unlink it; it is not the head, so it has a previous node
+        Node* previous = nodePrev(node);
+        Node* next = nodeNext(node);
+        setNodeNext(previous, next);
+        if (next != NULL) {
+            setNodePrev(next, previous);
+        }
+        else {
+            pList->tail = previous;
+        }
+        // And link it in again at the front
+        setNodePrev(node, NULL);
+        setNodeNext(node, pList->head);
+        setNodePrev(pList->head, node);
+        setListHead(pList, node);
+        pList->generation++;
+    }
+    pList->currIndex = 0;
+    pList->currIndexKnown = true;
+    return LIST_SUCCESS;
+}
+
+// Adds pList2 to the end of pList1. The current pointer is set to the current pointer of pList1. 
+// pList2 no longer exists after the operation; its head is available
+// for future operations.
+void List_concat(List* pList1, List* pList2) { 
+    assert(pList1 != NULL && pList2 != NULL);
+    assert(pList1->arena == pList2->arena); // Nodes cannot move between arenas
+
+    // pList2's head is about to be reused, so its retired nodes cannot wait for it
+    if (pList2->rcu && pList2->retired != NULL) {
+        List_rcu_reclaim(pList2);
+    }
+
+    if (pList2->head == NULL) {
+        freeHead(pList2); // pList2 is empty, only its head needs releasing
+        return;
+    }
+
+    // Carry pList2's nodes over into pList1's hash index. If there is no memory
+    // for that, the index is dropped rather than left incomplete.
+    if (pList1->index != NULL) {
+        if (ListIndex_reserve(pList1->index, pList2->size) == 0) {
+            for (Node* node = pList2->head; node != NULL; node = nodeNext(node)) {
+                ListIndex_insert(pList1->index, node);
+            }
+        }
+        else {
+            destroyIndex(pList1);
+        }
+    }
+
+    // If pList1 is not empty, link its last node to pList2's first node
+    if (pList1->tail != NULL) {
+        setNodeNext(pList1->tail, pList2->head);
+        setNodePrev(pList2->head, pList1->tail);
+    } 
+    else {
+        // If pList1 is empty, just set its head to pList2's head
+        setListHead(pList1, pList2->head);
+    }
+
+    // Update the tail of pList1 to be the tail of pList2
+    pList1->tail = pList2->tail;
+
+    pList1->size = pList2->size + pList1->size;
+    pList1->opCounts.inserts += pList2->size;
+    pList1->generation++;
+    // Reset pList2 and return its head to the pool
+    freeHead(pList2);
+}
+
+// Delete pList. pItemFreeFn is a pointer to a routine that frees an item. 
+// It should be invoked (within List_free) as: (*pItemFreeFn)(itemToBeFreedFromNode);
+// pList and all its nodes no longer exists after the operation; its head and nodes are 
+// available for future operations. If pItemFreeFn is NULL the items are left alone and
+// the nodes are released in O(1) time.
+typedef void (*FREE_FN)(void* pItem);
+void List_free(List* pList, FREE_FN pItemFreeFn){
+    assert(pList != NULL);
+
+    // Readers may still be walking an RCU list; wait them out before anything goes
+    if (pList->rcu) {
+        listRcuSynchronize();
+        freeRetired(pList);
+    }
+
+    // Free the data in each node using the provided function, if any
+    if (pItemFreeFn != NULL) {
+        Node* ahead = startLookahead(pList->head);
+        for (Node* currentNode = pList->head; currentNode != NULL; currentNode = nodeNext(currentNode)) {
+            ahead = advanceLookahead(ahead);
+            // Inline items go away with their nodes
+            if (!isInlineItem(currentNode)) {
+                pItemFreeFn(currentNode->data);
+            }
+        }
+    }
+
+    // The nodes are already linked, so the whole list goes back to the pool in one step
+    if (pList->head != NULL) {
+        depotFreeChain(pList->arena, pList->head, pList->tail, pList->size);
+    }
+
+    // Reset the list structure and add the head back to the pool of available list heads
+    freeHead(pList);
+}
+
+// Search pList, starting at the current item, until the end is reached or a match is found. 
+// In this context, a match is determined by the comparator parameter. This parameter is a
+// pointer to a routine that takes as its first argument an item pointer, and as its second 
+// argument pComparisonArg. Comparator returns 0 if the item and comparisonArg don't match, 
+// or 1 if they do. Exactly what constitutes a match is up to the implementor of comparator. 
+// 
+// If a match is found, the current pointer is left at the matched item and the pointer to 
+// that item is returned. If no match is found, the current pointer is left beyond the end of 
+// the list and a NULL pointer is returned.
+// 
+// If the current pointer is before the start of the pList, then start searching from
+// the first node in the list (if any).
+typedef bool (*COMPARATOR_FN)(void* pItem, void* pComparisonArg);
+void* List_search(List* pList, COMPARATOR_FN pComparator, void* pComparisonArg){
+    assert(pList != NULL && pComparator != NULL);
+
+    Node* currentNode = pList->curr;
+    int currentIndex = pList->currIndex;
+    int visited = 0;
+
+    // Reset out-of-bounds flags
+    pList->oob_start = false;
+    pList->oob_end = false;
+
+    // If the current pointer is before the start of the pList, start from the head
+    if (currentNode == NULL) {
+        currentNode = pList->head;
+        currentIndex = 0;
+        pList->currIndexKnown = true;
+    }
+
+    Node* ahead = startLookahead(currentNode);
+    while (currentNode != NULL) {
+        ahead = advanceLookahead(ahead);
+        visited++;
+        if (pComparator(currentNode->data, pComparisonArg)) {
+            pList->curr = currentNode;
+            pList->currIndex = currentIndex;
+            recordSearch(pList, visited);
+            return currentNode->data;
+        }
+        currentNode = nodeNext(currentNode);
+        currentIndex++;
+    }
+    recordSearch(pList, visited);
+
+    // Set the out-of-bounds end flag if no match was found
+    pList->oob_end = true;
+    pList->curr = NULL; // Ensuring the current pointer is NULL to indicate end of list
+    return NULL; // No match found
+}
+
+// Readies pList for a search loop outside this file and returns the node to start from.
+Node* List_search_start(List* pList){
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    if (pList->curr == NULL) {
+        pList->currIndex = 0;
+        pList->currIndexKnown = true;
+        return pList->head;
+    }
+    return pList->curr;
+}
+
+// Ends a search loop outside this file as List_search would, given the matching node
+// (NULL if none) and how many nodes the loop compared. Returns the matching item or NULL.
+void* List_search_finish(List* pList, Node* found, int visited){
+    assert(pList != NULL);
+
+    recordSearch(pList, visited);
+    if (found == NULL) {
+        pList->oob_end = true;
+        pList->curr = NULL;
+        return NULL;
+    }
+    // The loop started at curr, or at the head with currIndex set to 0
+    pList->currIndex += visited - 1;
+    pList->curr = found;
+    return found->data;
+}
+
+// Search pList a block of items at a time, as List_search does one item at a time.
+void* List_search_batch(List* pList, BATCH_COMPARATOR_FN pComparator, void* pComparisonArg){
+    assert(pList != NULL && pComparator != NULL);
+
+    void* items[LIST_SEARCH_BATCH];
+    Node* currentNode = List_search_start(pList);
+    int visited = 0;
+    Node* ahead = startLookahead(currentNode);
+    while (currentNode != NULL) {
+        Node* blockStart = currentNode;
+        int count = 0;
+        for (; currentNode != NULL && count < LIST_SEARCH_BATCH; currentNode = nodeNext(currentNode)) {
+            ahead = advanceLookahead(ahead);
+            items[count++] = currentNode->data;
+        }
+        int match = pComparator(items, count, pComparisonArg);
+        assert(match >= -1 && match < count);
+        if (match >= 0) {
+            // Only the items were gathered; step to the matching node again, which a
+            // search does once and the block is still in cache for
+            Node* found = blockStart;
+            for (int i = 0; i < match; i++) {
+                found = nodeNext(found);
+            }
+            return List_search_finish(pList, found, visited + match + 1);
+        }
+        visited += count;
+    }
+    return List_search_finish(pList, NULL, visited);
+}
+
+// How far ahead, in nodes, a merge fetches the nodes of its runs. Once runs outgrow the
+// cache their nodes are scattered, and each step of a merge would otherwise wait for a
+// node and then for its item. prev links are not needed until the sort ends, so each
+// merge leaves every node's prev pointing SORT_SKIP nodes further along its output run,
+// and the next merge up follows those to fetch ahead.
+#define SORT_SKIP 16
+
+// Fetches ahead along one input run of a merge: the node SORT_SKIP further on, and the
+// item of the one fetched SORT_SKIP/2 steps ago
+typedef struct {
+    Node* fetched[SORT_SKIP / 2];
+    int pos;
+} RunLookahead;
+
+static inline void advanceRun(RunLookahead* pAhead, Node* node) {
+    if (node == NULL) {
+        return;
+    }
+    // Until a merge has set it, prev is still a list link or a skip link left by an
+    // earlier merge; either way it is a node of this list, so following it is safe
+    Node* far = nodePrev(node);
+    prefetchNode(far);
+    Node* near = pAhead->fetched[pAhead->pos];
+    if (near != NULL) {
+        __builtin_prefetch(near->data);
+    }
+    pAhead->fetched[pAhead->pos] = far;
+    pAhead->pos = (pAhead->pos + 1) % (SORT_SKIP / 2);
+}
+
+// Merges the sorted runs a and b, each ending in a NULL next link, and returns the first
+// node. On ties a's node goes first, so with a holding the earlier items the merge is stable.
+static Node* mergeRuns(Node* a, Node* b, SORT_COMPARATOR_FN pCompare) {
+    RunLookahead aheadA = { { NULL }, 0 };
+    RunLookahead aheadB = { { NULL }, 0 };
+    Node* recent[SORT_SKIP] = { NULL }; // The last SORT_SKIP nodes output, for skip links
+    int recentPos = 0;
+
+    Node* first = NULL;
+    Node* last = NULL;
+    while (a != NULL && b != NULL) {
+        Node* node;
+        if (pCompare(b->data, a->data) < 0) {
+            node = b;
+            b = nodeNext(b);
+            advanceRun(&aheadB, b);
+        }
+        else {
+            node = a;
+            a = nodeNext(a);
+            advanceRun(&aheadA, a);
+        }
+        if (last != NULL) {
+            setNodeNext(last, node);
+        }
+        else {
+            first = node;
+        }
+        last = node;
+        if (recent[recentPos] != NULL) {
+            setNodePrev(recent[recentPos], node);
+        }
+        recent[recentPos] = node;
+        recentPos = (recentPos + 1) % SORT_SKIP;
+    }
+    setNodeNext(last, a != NULL ? a : b);
+    return first;
+}
+
+// Sorts pList in place with a stable bottom-up merge sort.
+int List_sort(List* pList, SORT_COMPARATOR_FN pCompare){
+    assert(pList != NULL && pCompare != NULL);
+
+    if (pList->rcu) {
+        return LIST_FAIL;
+    }
+    if (pList->size < 2) {
+        return LIST_SUCCESS;
+    }
+
+    // runs[k] is empty or a sorted run of 2^k nodes, and a run in a higher slot holds
+    // earlier items. Each node joins as a run of one and merges upwards like a carry,
+    // so runs are merged in equal sizes, and nothing is allocated.
+    Node* runs[sizeof(int) * 8] = { NULL };
+    int numSlots = 0;
+    Node* node = pList->head;
+    while (node != NULL) {
+        Node* next = nodeNext(node);
+        setNodeNext(node, NULL);
+        Node* run = node;
+        int slot = 0;
+        for (; runs[slot] != NULL; slot++) {
+            run = mergeRuns(runs[slot], run, pCompare);
+            runs[slot] = NULL;
+        }
+        runs[slot] = run;
+        if (slot >= numSlots) {
+            numSlots = slot + 1;
+        }
+        node = next;
+    }
+    Node* sorted = NULL;
+    for (int slot = 0; slot < numSlots; slot++) {
+        if (runs[slot] != NULL) {
+            sorted = sorted != NULL ? mergeRuns(runs[slot], sorted, pCompare) : runs[slot];
+        }
+    }
+
+    // The merges only kept next links; put back prev links and the tail in one pass
+    Node* previous = NULL;
+    for (node = sorted; node != NULL; node = nodeNext(node)) {
+        setNodePrev(node, previous);
+        previous = node;
+    }
+    setListHead(pList, sorted);
+    pList->tail = previous;
+    pList->generation++;
+    // curr is still the same node, at a position found again when next needed
+    if (pList->curr != NULL) {
+        pList->currIndexKnown = false;
+    }
+    return LIST_SUCCESS;
+}
+
+// A slot a compaction step may put a node in: a free one, or one of the step's nodes
+typedef struct CompactSlot_s CompactSlot;
+struct CompactSlot_s {
+    int index;
+    int target;     // Which of the step's nodes goes here, -1 if none does
+    bool occupied;  // By one of the step's nodes
+    bool released;  // Taken from the depot for the step
+};
+
+// A stretch of consecutive slots within one slab, as positions in the sorted slot array
+typedef struct CompactRun_s CompactRun;
+struct CompactRun_s {
+    int start;
+    int length;
+    bool continues; // Starts right after the node the last step ended at
+};
+
+static int compareCompactSlots(const void* p1, const void* p2) {
+    int a = ((const CompactSlot*)p1)->index;
+    int b = ((const CompactSlot*)p2)->index;
+    return (a > b) - (a < b);
+}
+
+// The stretch that continues the last step's first, then longer ones, then lower ones
+static int compareCompactRuns(const void* p1, const void* p2) {
+    const CompactRun* a = p1;
+    const CompactRun* b = p2;
+    if (a->continues != b->continues) {
+        return a->continues ? -1 : 1;
+    }
+    if (a->length != b->length) {
+        return a->length > b->length ? -1 : 1;
+    }
+    return (a->start > b->start) - (a->start < b->start);
+}
+
+// Whether slots[j] is a released slot left empty right next to slots[i] in the same slab
+static bool isSpareNeighbour(const CompactSlot* slots, int numSlots, int i, int j) {
+    if (j < 0 || j >= numSlots || !slots[j].released || slots[j].occupied) {
+        return false;
+    }
+    int low = slots[i < j ? i : j].index;
+    int high = slots[i < j ? j : i].index;
+    return high == low + 1 && (high & (POOL_SLAB_SIZE - 1)) != 0;
+}
+
+// Takes up to maxCount of arena's released node indices into indices, in the order its
+// depot hands them out (after putting this thread's magazine back), without growing the
+// pool. Returns how many were taken, in O(maxCount) time.
+static int takeFreeNodes(ListArena* arena, int* indices, int maxCount) {
+    Pool* pool = &arena->nodePool;
+    int count = 0;
+    pthread_mutex_lock(&arena->nodeLock);
+    if (arena == &defaultArena) {
+        Pool_freeBatch(pool, nodeMagazine.indices, nodeMagazine.count);
+        nodeMagazine.count = 0;
+    }
+    while (count < maxCount && (arena->freeChain != NULL || pool->freeTop >= 0)) {
+        indices[count++] = depotAllocNodeIndex(arena);
+    }
+    pthread_mutex_unlock(&arena->nodeLock);
+    return count;
+}
+
+// Links node, whose own links are set, in between its neighbours
+static void linkBetweenNeighbours(List* pList, Node* node) {
+    Node* previous = nodePrev(node);
+    Node* next = nodeNext(node);
+    if (previous != NULL) {
+        setNodeNext(previous, node);
+    }
+    else {
+        setListHead(pList, node);
+    }
+    if (next != NULL) {
+        setNodePrev(next, node);
+    }
+    else {
+        pList->tail = node;
+    }
+}
+
+// Moves node's item and place in pList to the free slot target
+static void moveNode(List* pList, Node* node, Node* target) {
+    if (isInlineItem(node)) {
+        memcpy(nodePayload(target), nodePayload(node), pList->arena->payloadSize);
+        target->data = nodePayload(target);
+    }
+    else {
+        target->data = node->data;
+    }
+    setNodePrev(target, nodePrev(node));
+    setNodeNext(target, nodeNext(node));
+    linkBetweenNeighbours(pList, target);
+    if (pList->curr == node) {
+        pList->curr = target;
+    }
+    if (pList->index != NULL) {
+        ListIndex_replace(pList->index, node, target);
+    }
+}
+
+// Swaps the items and places in pList of nodes a and b. scratch holds an inline item.
+static void swapNodes(List* pList, Node* a, Node* b, void* scratch) {
+    if (pList->index != NULL) {
+        // a's entry goes through a stand-in, so that no two entries are ever the same node
+        Node standIn;
+        standIn.data = a->data;
+        ListIndex_replace(pList->index, a, &standIn);
+        ListIndex_replace(pList->index, b, a);
+        ListIndex_replace(pList->index, &standIn, b);
+    }
+    bool aInline = isInlineItem(a);
+    bool bInline = isInlineItem(b);
+    void* aData = a->data;
+    void* bData = b->data;
+    if (aInline || bInline) {
+        size_t payloadSize = pList->arena->payloadSize;
+        memcpy(scratch, nodePayload(a), payloadSize);
+        memcpy(nodePayload(a), nodePayload(b), payloadSize);
+        memcpy(nodePayload(b), scratch, payloadSize);
+    }
+    a->data = bInline ? nodePayload(a) : bData;
+    b->data = aInline ? nodePayload(b) : aData;
+
+    // Each takes the other's links, where a link to itself means the other one
+    Node* aPrev = nodePrev(a);
+    Node* aNext = nodeNext(a);
+    Node* bPrev = nodePrev(b);
+    Node* bNext = nodeNext(b);
+    setNodePrev(a, bPrev == a ? b : bPrev);
+    setNodeNext(a, bNext == a ? b : bNext);
+    setNodePrev(b, aPrev == b ? a : aPrev);
+    setNodeNext(b, aNext == b ? a : aNext);
+    linkBetweenNeighbours(pList, a);
+    linkBetweenNeighbours(pList, b);
+    if (pList->curr == a) {
+        pList->curr = b;
+    }
+    else if (pList->curr == b) {
+        pList->curr = a;
+    }
+}
+
+// Lays out up to maxNodes of pList's nodes, from first on, over the slots they are in and
+// up to twice as many released slots taken from the front of the arena's depot: the
+// stretch of consecutive slots right after previous first, if there is one, then the
+// longest stretches. A node whose slot is taken by another of them swaps places with it,
+// and one whose slot is free moves in. The slots left over go back, so the pool never
+// grows. Takes O(maxNodes log maxNodes) time however many slots are free, holding
+// nodeLock only to take and give back slots. Returns the last node laid out, or NULL if
+// there is no memory.
+static Node* compactNodes(List* pList, Node* previous, Node* first, int maxNodes) {
+    ListArena* arena = pList->arena;
+    Pool* pool = &arena->nodePool;
+    CompactSlot* slots = malloc(3 * (size_t)maxNodes * sizeof(CompactSlot));
+    CompactRun* runs = malloc(3 * (size_t)maxNodes * sizeof(CompactRun));
+    int* targets = malloc(maxNodes * sizeof(int)); // Positions in slots, in list order
+    int* indices = malloc(3 * (size_t)maxNodes * sizeof(int)); // Slots taken, then slots to give back
+    void* scratch = malloc(arena->payloadSize + 1);
+    if (slots == NULL || runs == NULL || targets == NULL || indices == NULL || scratch == NULL) {
+        free(slots);
+        free(runs);
+        free(targets);
+        free(indices);
+        free(scratch);
         return NULL;
     }
-    Node* nodeToRemove = pList->tail;
-    void* item = nodeToRemove->data;
 
-    pList->tail = nodeToRemove->prev;
-    if (pList->tail != NULL) {
-        pList->tail->next = NULL;
-    } else {
-        // The list is now empty
-        pList->head = NULL;
+    int count = 0;
+    for (Node* node = first; node != NULL && count < maxNodes; node = nodeNext(node)) {
+        slots[count++] = (CompactSlot){ Pool_indexOf(pool, node), -1, true, false };
+    }
+    int numTaken = takeFreeNodes(arena, indices, 2 * count);
+    int numSlots = count;
+    for (int i = 0; i < numTaken; i++) {
+        slots[numSlots++] = (CompactSlot){ indices[i], -1, false, true };
     }
+    qsort(slots, numSlots, sizeof(CompactSlot), compareCompactSlots);
 
-    if (pList->curr == nodeToRemove) {
-        pList->curr = pList->tail;
+    // Stretches end at a gap and at the end of a slab
+    int after = -1;
+    if (previous != NULL && ((Pool_indexOf(pool, previous) + 1) & (POOL_SLAB_SIZE - 1)) != 0) {
+        after = Pool_indexOf(pool, previous) + 1;
+    }
+    int numRuns = 0;
+    for (int i = 0; i < numSlots; i++) {
+        int index = slots[i].index;
+        if (i > 0 && index == slots[i - 1].index + 1 && (index & (POOL_SLAB_SIZE - 1)) != 0) {
+            runs[numRuns - 1].length++;
+        }
+        else {
+            runs[numRuns++] = (CompactRun){ i, 1, index == after };
+        }
+    }
+    qsort(runs, numRuns, sizeof(CompactRun), compareCompactRuns);
+    // Once the nodes left fit in a stretch, the shortest one they fit in takes them, so
+    // nodes that lie in one already stay there
+    int numTargets = 0;
+    for (int r = 0; numTargets < count; r++) {
+        int left = count - numTargets;
+        if ((r > 0 || !runs[r].continues) && runs[r].length > left) {
+            int fit = r;
+            while (fit + 1 < numRuns && runs[fit + 1].length >= left) {
+                fit++;
+            }
+            while (fit > r && runs[fit - 1].length == runs[fit].length) {
+                fit--;
+            }
+            r = fit;
+        }
+        for (int i = runs[r].start; i < runs[r].start + runs[r].length && numTargets < count; i++) {
+            slots[i].target = numTargets;
+            targets[numTargets++] = i;
+        }
     }
 
-    pList->size--;
-    freeNode(nodeToRemove);
-    return item;
+    // Place the nodes in list order. A slot before the current target holds its node
+    // already, so a taken target holds one of the nodes still to come.
+    Node* node = first;
+    Node* target = NULL;
+    for (int k = 0; k < count; k++) {
+        CompactSlot* slot = &slots[targets[k]];
+        target = Pool_at(pool, slot->index);
+        if (node != target) {
+            if (slot->occupied) {
+                swapNodes(pList, node, target, scratch);
+            }
+            else {
+                CompactSlot key = { .index = Pool_indexOf(pool, node) };
+                CompactSlot* left = bsearch(&key, slots, numSlots, sizeof(CompactSlot), compareCompactSlots);
+                moveNode(pList, node, target);
+                slot->occupied = true;
+                left->occupied = false;
+            }
+            pList->generation++;
+        }
+        node = nodeNext(target);
+    }
+
+    // Released slots left empty next to another go back in front of the depot in the
+    // order they were taken, so the next step (or one starting over) finds the stretches
+    // they make up again. Lone ones, and the slots nodes moved out of, go to the pool,
+    // highest first, so the lowest is handed out first.
+    for (int i = 0; i < numSlots; i++) {
+        if (slots[i].released && !slots[i].occupied
+            && !isSpareNeighbour(slots, numSlots, i, i - 1) && !isSpareNeighbour(slots, numSlots, i, i + 1)) {
+            slots[i].released = false;
+        }
+    }
+    Node* chainFirst = NULL;
+    Node* chainLast = NULL;
+    int chainLength = 0;
+    for (int i = 0; i < numTaken; i++) {
+        CompactSlot key = { .index = indices[i] };
+        CompactSlot* slot = bsearch(&key, slots, numSlots, sizeof(CompactSlot), compareCompactSlots);
+        if (!slot->occupied && slot->released) {
+            Node* free = Pool_at(pool, indices[i]);
+            if (chainLast != NULL) {
+                setNodeNext(chainLast, free);
+            }
+            else {
+                chainFirst = free;
+            }
+            chainLast = free;
+            chainLength++;
+        }
+    }
+    int numFreed = 0;
+    for (int i = numSlots - 1; i >= 0; i--) {
+        if (!slots[i].occupied && !slots[i].released) {
+            indices[numFreed++] = slots[i].index;
+        }
+    }
+    pthread_mutex_lock(&arena->nodeLock);
+    if (chainLength > 0) {
+        depotPushChain(arena, chainFirst, chainLast, chainLength);
+    }
+    Pool_freeBatch(pool, indices, numFreed);
+    pthread_mutex_unlock(&arena->nodeLock);
+    free(slots);
+    free(runs);
+    free(targets);
+    free(indices);
+    free(scratch);
+    return target;
 }
 
-// Adds pList2 to the end of pList1. The current pointer is set to the current pointer of pList1. 
-// pList2 no longer exists after the operation; its head is available
-// for future operations.
-void List_concat(List* pList1, List* pList2) { 
-    assert(pList1 != NULL && pList2 != NULL);
+// Sets up pCompactor to compact pList from its first item.
+void ListCompactor_init(ListCompactor* pCompactor, List* pList){
+    assert(pCompactor != NULL && pList != NULL);
 
-    if (pList2->head == NULL) {
-        return; // pList2 is empty, nothing to do
+    pCompactor->pList = pList;
+    pCompactor->done = NULL;
+    pCompactor->generation = pList->generation;
+}
+
+// Compacts up to maxNodes more nodes of the compactor's list.
+int ListCompactor_step(ListCompactor* pCompactor, int maxNodes){
+    assert(pCompactor != NULL && maxNodes > 0);
+
+    // Readers could be on the nodes being moved
+    List* pList = pCompactor->pList;
+    if (pList->rcu) {
+        return LIST_FAIL;
+    }
+    // Any other change since the last step may have released or moved the node it ended at
+    if (pList->generation != pCompactor->generation) {
+        pCompactor->done = NULL;
     }
 
-    // If pList1 is not empty, link its last node to pList2's first node
-    if (pList1->tail != NULL) {
-        pList1->tail->next = pList2->head;
-        pList2->head->prev = pList1->tail;
-    } 
+    Node* previous = pCompactor->done;
+    Node* first = previous != NULL ? nodeNext(previous) : pList->head;
+    if (first == NULL) {
+        pCompactor->generation = pList->generation;
+        return 0;
+    }
+    Node* last = compactNodes(pList, previous, first, maxNodes < pList->size ? maxNodes : pList->size);
+    pCompactor->generation = pList->generation;
+    if (last == NULL) {
+        return LIST_FAIL;
+    }
+    pCompactor->done = last;
+    return nodeNext(last) != NULL ? 1 : 0;
+}
+
+// Compacts the whole of pList.
+int List_compact(List* pList){
+    assert(pList != NULL);
+
+    ListCompactor compactor;
+    ListCompactor_init(&compactor, pList);
+    return ListCompactor_step(&compactor, INT_MAX) < 0 ? LIST_FAIL : LIST_SUCCESS;
+}
+
+static int compareIndices(const void* p1, const void* p2) {
+    int a = *(const int*)p1;
+    int b = *(const int*)p2;
+    return (a > b) - (a < b);
+}
+
+// Index of the head handed out position-th from arena's head pool, counting in slab order
+static int headIndexAt(Pool* heads, int position) {
+    return (heads->slabNumbers[position >> POOL_SLAB_SHIFT] << POOL_SLAB_SHIFT)
+        | (position & (POOL_SLAB_SIZE - 1));
+}
+
+// Finds the first list in arena, not in RCU mode, whose head is at *pPosition or after it,
+// and stores its position in *pPosition and the list in *ppList. Holds headLock meanwhile.
+// Returns 1 if there is one, 0 if there is none, or -1 if there is no memory.
+static int findArenaList(ListArena* arena, int* pPosition, List** ppList) {
+    // Every head handed out and not on the free stack is a list; sort the free ones
+    // so each head can be looked up among them
+    Pool* heads = &arena->listPool;
+    pthread_mutex_lock(&arena->headLock);
+    int numFree = heads->freeTop + 1;
+    int* freeHeads = malloc((numFree > 0 ? numFree : 1) * sizeof(int));
+    if (freeHeads == NULL) {
+        pthread_mutex_unlock(&arena->headLock);
+        return LIST_FAIL;
+    }
+    memcpy(freeHeads, heads->freeStack, numFree * sizeof(int));
+    qsort(freeHeads, numFree, sizeof(int), compareIndices);
+
+    int found = 0;
+    for (int position = *pPosition; position < heads->bump && !found; position++) {
+        int listIndex = headIndexAt(heads, position);
+        List* pList = Pool_at(heads, listIndex);
+        if (!pList->rcu && bsearch(&listIndex, freeHeads, numFree, sizeof(int), compareIndices) == NULL) {
+            *pPosition = position;
+            *ppList = pList;
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&arena->headLock);
+    free(freeHeads);
+    return found;
+}
+
+// Whether the head at position in arena is still a list, not in RCU mode
+static bool isArenaList(ListArena* arena, int position) {
+    Pool* heads = &arena->listPool;
+    pthread_mutex_lock(&arena->headLock);
+    int listIndex = headIndexAt(heads, position);
+    bool live = position < heads->bump && !((List*)Pool_at(heads, listIndex))->rcu;
+    for (int i = 0; i <= heads->freeTop && live; i++) {
+        live = heads->freeStack[i] != listIndex;
+    }
+    pthread_mutex_unlock(&arena->headLock);
+    return live;
+}
+
+// Moves pCompactor on to the first list at its position or after it.
+// Returns 1 if there is one, 0 if there is none, or -1 if there is no memory.
+static int startArenaList(ListArenaCompactor* pCompactor) {
+    List* pList = NULL;
+    int found = findArenaList(pCompactor->arena, &pCompactor->position, &pList);
+    pCompactor->list.pList = NULL;
+    if (found > 0) {
+        ListCompactor_init(&pCompactor->list, pList);
+    }
+    return found;
+}
+
+// Sets up pCompactor to compact every list made in arena (the default arena if arena is NULL).
+void ListArenaCompactor_init(ListArenaCompactor* pCompactor, ListArena* arena){
+    assert(pCompactor != NULL);
+
+    if (arena == NULL) {
+        initializePoolsIfNeeded();
+        initializeHeadPoolsIfNeeded();
+        arena = &defaultArena;
+    }
+    pCompactor->arena = arena;
+    pCompactor->position = 0;
+    pCompactor->list.pList = NULL;
+    pCompactor->compacted = 0;
+}
+
+// Compacts up to maxNodes more nodes of the compactor's current list, going on to the next.
+int ListArenaCompactor_step(ListArenaCompactor* pCompactor, int maxNodes){
+    assert(pCompactor != NULL && maxNodes > 0);
+
+    // The list may have been freed, or put in RCU mode, since the last step
+    if (pCompactor->list.pList != NULL && !isArenaList(pCompactor->arena, pCompactor->position)) {
+        pCompactor->position++;
+        pCompactor->list.pList = NULL;
+    }
+    if (pCompactor->list.pList == NULL) {
+        int found = startArenaList(pCompactor);
+        if (found <= 0) {
+            return found;
+        }
+    }
+
+    int result = ListCompactor_step(&pCompactor->list, maxNodes);
+    if (result < 0) {
+        return LIST_FAIL;
+    }
+    if (result == 0) {
+        pCompactor->compacted++;
+        pCompactor->position++;
+        return startArenaList(pCompactor);
+    }
+    return 1;
+}
+
+// Compacts every list made in arena (the default arena if arena is NULL).
+int ListArena_compact(ListArena* arena){
+    ListArenaCompactor compactor;
+    ListArenaCompactor_init(&compactor, arena);
+    int result;
+    while ((result = ListArenaCompactor_step(&compactor, INT_MAX)) == 1) {
+    }
+    return result < 0 ? LIST_FAIL : compactor.compacted;
+}
+
+// Sets up pIter on pList, before the start.
+void ListIter_init(ListIter* pIter, List* pList){
+    assert(pIter != NULL && pList != NULL);
+
+    pIter->pList = pList;
+    pIter->node = NULL;
+    pIter->oob = LIST_OOB_START;
+}
+
+// Sets up pIter on pList at pList's current item, without changing pList.
+void ListIter_at_curr(ListIter* pIter, List* pList){
+    assert(pIter != NULL && pList != NULL);
+
+    pIter->pList = pList;
+    pIter->node = pList->curr;
+    pIter->oob = pList->oob_end ? LIST_OOB_END : LIST_OOB_START;
+}
+
+// Moves pIter to the first item of pList and returns it, or NULL if pList is empty.
+void* ListIter_begin(ListIter* pIter, List* pList){
+    assert(pIter != NULL && pList != NULL);
+
+    pIter->pList = pList;
+    pIter->node = listHead(pList);
+    pIter->oob = LIST_OOB_START;
+    return pIter->node != NULL ? pIter->node->data : NULL;
+}
+
+// Moves pIter to the last item of pList and returns it, or NULL if pList is empty.
+void* ListIter_end(ListIter* pIter, List* pList){
+    assert(pIter != NULL && pList != NULL);
+
+    pIter->pList = pList;
+    pIter->node = pList->tail;
+    pIter->oob = LIST_OOB_END;
+    return pIter->node != NULL ? pIter->node->data : NULL;
+}
+
+// Moves pIter on by one and returns the new item. Past the last item, pIter is left
+// beyond the end and NULL is returned; from before the start, it moves to the first item.
+void* ListIter_next(ListIter* pIter){
+    assert(pIter != NULL);
+
+    if (pIter->node == NULL) {
+        if (pIter->oob == LIST_OOB_END) {
+            return NULL;
+        }
+        pIter->node = listHead(pIter->pList);
+    }
     else {
-        // If pList1 is empty, just set its head to pList2's head
-        pList1->head = pList2->head;
+        pIter->node = nodeNext(pIter->node);
+    }
+    if (pIter->node == NULL) {
+        pIter->oob = LIST_OOB_END;
+        return NULL;
     }
+    prefetchNode(nodeNext(pIter->node));
+    return pIter->node->data;
+}
 
-    // Update the tail of pList1 to be the tail of pList2
-    pList1->tail = pList2->tail;
+// Moves pIter back by one and returns the new item. Before the first item, pIter is left
+// before the start and NULL is returned; from beyond the end, it moves to the last item.
+void* ListIter_prev(ListIter* pIter){
+    assert(pIter != NULL);
 
-    pList1->size = pList2->size + pList1->size;
-    // Reset pList2
-    int listIndex = pList2 - listPool; // Calculate index based on pointer arithmetic
-    freeListStack[listStackTopINdx] = listIndex;
-    listStackTopINdx++;
-    numFreeHeads++;
+    if (pIter->node == NULL) {
+        if (pIter->oob == LIST_OOB_START) {
+            return NULL;
+        }
+        pIter->node = pIter->pList->tail;
+    }
+    else {
+        pIter->node = nodePrev(pIter->node);
+    }
+    if (pIter->node == NULL) {
+        pIter->oob = LIST_OOB_START;
+        return NULL;
+    }
+    prefetchNode(nodePrev(pIter->node));
+    return pIter->node->data;
 }
 
-// Delete pList. pItemFreeFn is a pointer to a routine that frees an item. 
-// It should be invoked (within List_free) as: (*pItemFreeFn)(itemToBeFreedFromNode);
-// pList and all its nodes no longer exists after the operation; its head and nodes are 
-// available for future operations.
-typedef void (*FREE_FN)(void* pItem);
-void List_free(List* pList, FREE_FN pItemFreeFn){
+// Returns the item pIter is at, or NULL if it is before the start or beyond the end.
+void* ListIter_item(ListIter* pIter){
+    assert(pIter != NULL);
+
+    return pIter->node != NULL ? pIter->node->data : NULL;
+}
+
+// Searches from pIter's item as List_search does, moving pIter instead of the list's
+// current item. The list's counters are left alone, since other readers may be searching
+// it too; the search still counts towards this thread's search-length histogram.
+void* ListIter_search(ListIter* pIter, COMPARATOR_FN pComparator, void* pComparisonArg){
+    assert(pIter != NULL && pComparator != NULL);
+
+    Node* currentNode = pIter->node;
+    if (currentNode == NULL && pIter->oob == LIST_OOB_START) {
+        currentNode = listHead(pIter->pList);
+    }
+
+    int visited = 0;
+    Node* ahead = startLookahead(currentNode);
+    for (; currentNode != NULL; currentNode = nodeNext(currentNode)) {
+        ahead = advanceLookahead(ahead);
+        visited++;
+        if (pComparator(currentNode->data, pComparisonArg)) {
+            break;
+        }
+    }
+    recordSearchLength(visited);
+
+    pIter->node = currentNode;
+    pIter->oob = LIST_OOB_END;
+    return currentNode != NULL ? currentNode->data : NULL;
+}
+
+// Puts pList in RCU mode: removed nodes are retired until no reader can still see them.
+// Returns 0 on success, -1 on failure.
+int List_enable_rcu(List* pList){
     assert(pList != NULL);
-    assert(pItemFreeFn != NULL);
 
-    // Iterate through each node in the list
-    Node* currentNode = pList->head;
-    while (currentNode != NULL) {
-        Node* tempNode = currentNode;
-        currentNode = currentNode->next;
+    // Grace periods only cover this process's threads, and retired nodes would be
+    // lost from the file after a crash
+    if (pList->arena->file != NULL) {
+        return -1;
+    }
+    pList->rcu = true;
+    return 0;
+}
 
-        // Free the data in the node using the provided function
-        pItemFreeFn(tempNode->data);
+// Waits for a grace period, then frees every node pList has retired.
+void List_rcu_reclaim(List* pList){
+    assert(pList != NULL);
 
-        freeNode(tempNode);
+    if (pList->retired == NULL) {
+        return;
     }
+    listRcuSynchronize();
+    freeRetired(pList);
+}
 
-    // Reset the list structure
-    pList->head = NULL;
-    pList->tail = NULL;
-    pList->curr = NULL;
-    pList->size = 0;
-    pList->oob_start = false;
-    pList->oob_end = false;
+// Gives pList a hash index so that List_find_key can jump straight to an item.
+// Returns 0 on success, -1 on failure.
+int List_enable_index(List* pList, HASH_FN pHash, COMPARATOR_FN pEqual){
+    assert(pList != NULL && pHash != NULL && pEqual != NULL);
+
+    // An index lives in process memory, which a persistent list would outlive
+    if (pList->arena->file != NULL) {
+        return -1;
+    }
+
+    ListIndex* pIndex = ListIndex_create(pHash, pEqual);
+    if (pIndex == NULL || ListIndex_reserve(pIndex, pList->size) != 0) {
+        if (pIndex != NULL) {
+            ListIndex_destroy(pIndex);
+        }
+        return -1;
+    }
+    for (Node* node = pList->head; node != NULL; node = nodeNext(node)) {
+        ListIndex_insert(pIndex, node);
+    }
 
-    // Add the list head back to the pool of available list heads
-    int listIndex = pList - listPool; // Correct reference to listPool
-    listStackTopINdx++;
-    freeListStack[listStackTopINdx] = listIndex;
-    numFreeHeads++;
+    destroyIndex(pList);
+    attachIndex(pList, pIndex);
+    return 0;
 }
 
-// Search pList, starting at the current item, until the end is reached or a match is found. 
-// In this context, a match is determined by the comparator parameter. This parameter is a
-// pointer to a routine that takes as its first argument an item pointer, and as its second 
-// argument pComparisonArg. Comparator returns 0 if the item and comparisonArg don't match, 
-// or 1 if they do. Exactly what constitutes a match is up to the implementor of comparator. 
-// 
-// If a match is found, the current pointer is left at the matched item and the pointer to 
-// that item is returned. If no match is found, the current pointer is left beyond the end of 
-// the list and a NULL pointer is returned.
-// 
-// If the current pointer is before the start of the pList, then start searching from
-// the first node in the list (if any).
-typedef bool (*COMPARATOR_FN)(void* pItem, void* pComparisonArg);
-void* List_search(List* pList, COMPARATOR_FN pComparator, void* pComparisonArg){
-    assert(pList != NULL && pComparator != NULL);
+// Drops pList's hash index, if it has one.
+void List_disable_index(List* pList){
+    assert(pList != NULL);
 
-    Node* currentNode = pList->curr;
+    destroyIndex(pList);
+}
 
-    // Reset out-of-bounds flags
+// Finds an item matching pKey through pList's hash index, makes it the current item
+// and returns it. If none matches, the current pointer is left beyond the end of the list.
+void* List_find_key(List* pList, void* pKey){
+    assert(pList != NULL && pList->index != NULL);
+
+    Node* node = ListIndex_find(pList->index, pKey);
+    pList->opCounts.keyLookups++;
     pList->oob_start = false;
+    if (node == NULL) {
+        pList->oob_end = true;
+        pList->curr = NULL;
+        return NULL;
+    }
     pList->oob_end = false;
+    pList->curr = node;
+    pList->currIndexKnown = false; // Counted on demand by List_index_of_curr
+    return node->data;
+}
 
-    // If the current pointer is before the start of the pList, start from the head
-    if (currentNode == NULL) {
-        currentNode = pList->head;
-    }
+// Writes pList to the file at path, one recordSize-byte record per item. Records are
+// gathered in a buffer of about SNAPSHOT_BUFFER_BYTES and written a buffer at a time.
+// Returns 0 on success, -1 on failure.
+int List_save(List* pList, const char* path, size_t recordSize, SERIALIZE_FN pSerialize){
+    assert(pList != NULL && path != NULL && recordSize > 0 && recordSize <= UINT32_MAX);
 
-    while (currentNode != NULL) {
-        if (pComparator(currentNode->data, pComparisonArg)) {
-            pList->curr = currentNode;
-            return currentNode->data;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    size_t bufferRecords = recordSize < SNAPSHOT_BUFFER_BYTES ? SNAPSHOT_BUFFER_BYTES / recordSize : 1;
+    char* buffer = malloc(bufferRecords * recordSize);
+
+    SnapshotHeader header = { .version = SNAPSHOT_VERSION, .recordSize = (uint32_t)recordSize, .count = (uint64_t)pList->size };
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    bool written = buffer != NULL && fwrite(&header, sizeof(header), 1, file) == 1;
+
+    size_t buffered = 0;
+    Node* ahead = startLookahead(pList->head);
+    for (Node* node = pList->head; written && node != NULL; node = nodeNext(node)) {
+        ahead = advanceLookahead(ahead);
+        char* pRecord = buffer + buffered * recordSize;
+        if (pSerialize != NULL) {
+            pSerialize(node->data, pRecord);
+        }
+        else {
+            memcpy(pRecord, node->data, recordSize);
         }
-        currentNode = currentNode->next;
+        if (++buffered == bufferRecords) {
+            written = fwrite(buffer, recordSize, buffered, file) == buffered;
+            buffered = 0;
+        }
+    }
+    if (written && buffered > 0) {
+        written = fwrite(buffer, recordSize, buffered, file) == buffered;
     }
 
-    // Set the out-of-bounds end flag if no match was found
-    pList->oob_end = true;
-    pList->curr = NULL; // Ensuring the current pointer is NULL to indicate end of list
-    return NULL; // No match found
+    free(buffer);
+    if (fclose(file) != 0) {
+        written = false;
+    }
+    return written ? 0 : -1;
+}
+
+// Makes a new list in the default arena from the snapshot at path.
+// Returns a NULL pointer on failure.
+List* List_load(const char* path, DESERIALIZE_FN pDeserialize){
+    initializePoolsIfNeeded();
+    initializeHeadPoolsIfNeeded();
+
+    return List_load_in(&defaultArena, path, pDeserialize);
 }
 
+// Makes a new list in arena from the snapshot at path.
+// Returns a NULL pointer on failure.
+List* List_load_in(ListArena* arena, const char* path, DESERIALIZE_FN pDeserialize){
+    assert(arena != NULL && path != NULL);
 
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SnapshotHeader)) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE; // Map the whole file up front rather than faulting in each page
+#endif
+        map = mmap(NULL, st.st_size, PROT_READ, flags, fd, 0);
+    }
+    close(fd); // The mapping stays valid without the descriptor
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    const SnapshotHeader* header = map;
+    List* pList = NULL;
+    if (snapshotValid(header, st.st_size) && (pDeserialize != NULL || arena->payloadSize == header->recordSize)) {
+        pList = List_create_in(arena);
+        if (pList != NULL && loadRecords(pList, (const char*)(header + 1), header->recordSize, (int)header->count, pDeserialize) != 0) {
+            freeHead(pList);
+            pList = NULL;
+        }
+    }
+    munmap(map, st.st_size);
+    return pList;
+}
 
+// Copies pList's operation counters into pCounts.
+void List_get_op_counts(List* pList, ListOpCounts* pCounts){
+    assert(pList != NULL && pCounts != NULL);
 
+    *pCounts = pList->opCounts;
+}
 
+// Fills in pStats with the state of the default arena's node and head pools and
+// counters summed over every thread. Counters from other threads may lag slightly behind.
+void List_get_pool_stats(ListPoolStats* pStats){
+    assert(pStats != NULL);
 
+    initializePoolsIfNeeded();
+    initializeHeadPoolsIfNeeded();
 
+    ThreadStats totals = { 0 };
+    pthread_mutex_lock(&statsLock);
+    addThreadStats(&totals, &exitedThreadStats);
+    for (NodeMagazine* pMagazine = registeredMagazines; pMagazine != NULL; pMagazine = pMagazine->nextRegistered) {
+        addThreadStats(&totals, &pMagazine->stats);
+    }
+    pthread_mutex_unlock(&statsLock);
+
+    pthread_mutex_lock(&defaultArena.nodeLock);
+    pStats->nodeCapacity = Pool_capacity(&defaultArena.nodePool);
+    pStats->nodesReserved = defaultArena.nodePool.numInUse - defaultArena.freeChainLength;
+    pStats->nodesHighWater = defaultArena.nodePool.highWater;
+    pthread_mutex_unlock(&defaultArena.nodeLock);
+    pStats->nodesInUse = (int64_t)(totals.nodeAllocs - totals.nodeFrees);
+    pStats->nodeAllocFailures = totals.nodeAllocFailures;
+
+    pthread_mutex_lock(&defaultArena.headLock);
+    pStats->headCapacity = Pool_capacity(&defaultArena.listPool);
+    pStats->headsInUse = defaultArena.listPool.numInUse;
+    pStats->headsHighWater = defaultArena.listPool.highWater;
+    pStats->headAllocFailures = defaultArena.listPool.allocFailures;
+    pthread_mutex_unlock(&defaultArena.headLock);
+
+    pStats->searches = 0;
+    for (int i = 0; i < LIST_SEARCH_HISTOGRAM_BUCKETS; i++) {
+        pStats->searchLengths[i] = totals.searchLengths[i];
+        pStats->searches += totals.searchLengths[i];
+    }
+}
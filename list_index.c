@@ -0,0 +1,169 @@
+// Open-addressing hash table from item keys to list nodes, used by
+// List_enable_index. Linear probing over a power-of-two table kept at most
+// half full; deletions shift later entries back instead of leaving tombstones.
+
+#include "list_internal.h"
+#include <assert.h>
+#include <stdlib.h>
+
+typedef struct IndexEntry_s IndexEntry;
+struct IndexEntry_s {
+    size_t hash;   // Mixed hash of the node's item
+    Node* node;    // NULL for an empty slot
+};
+
+struct ListIndex_s {
+    HASH_FN pHash;
+    COMPARATOR_FN pEqual;
+    IndexEntry* entries;
+    size_t mask;       // Capacity - 1
+    int count;
+    ListIndex* prevLinked; // Neighbours on the owning arena's list of indexes
+    ListIndex* nextLinked;
+};
+
+#define LIST_INDEX_MIN_CAPACITY 16
+
+// Spreads user hashes (often small integers) over all bits
+static size_t mixHash(size_t hash) {
+    uint64_t h = hash;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+// Places an entry, known not to be present, in the first free slot of its probe sequence
+static void placeEntry(IndexEntry* entries, size_t mask, size_t hash, Node* node) {
+    size_t slot = hash & mask;
+    while (entries[slot].node != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    entries[slot].hash = hash;
+    entries[slot].node = node;
+}
+
+static int resizeIndex(ListIndex* pIndex, size_t capacity) {
+    IndexEntry* entries = calloc(capacity, sizeof(IndexEntry));
+    if (entries == NULL) {
+        return -1;
+    }
+    if (pIndex->entries != NULL) {
+        for (size_t i = 0; i <= pIndex->mask; i++) {
+            if (pIndex->entries[i].node != NULL) {
+                placeEntry(entries, capacity - 1, pIndex->entries[i].hash, pIndex->entries[i].node);
+            }
+        }
+        free(pIndex->entries);
+    }
+    pIndex->entries = entries;
+    pIndex->mask = capacity - 1;
+    return 0;
+}
+
+ListIndex* ListIndex_create(HASH_FN pHash, COMPARATOR_FN pEqual) {
+    ListIndex* pIndex = malloc(sizeof(ListIndex));
+    if (pIndex == NULL) {
+        return NULL;
+    }
+    pIndex->pHash = pHash;
+    pIndex->pEqual = pEqual;
+    pIndex->entries = NULL;
+    pIndex->count = 0;
+    pIndex->prevLinked = NULL;
+    pIndex->nextLinked = NULL;
+    if (resizeIndex(pIndex, LIST_INDEX_MIN_CAPACITY) != 0) {
+        free(pIndex);
+        return NULL;
+    }
+    return pIndex;
+}
+
+void ListIndex_destroy(ListIndex* pIndex) {
+    free(pIndex->entries);
+    free(pIndex);
+}
+
+void ListIndex_link(ListIndex* pIndex, ListIndex** pFirst) {
+    pIndex->prevLinked = NULL;
+    pIndex->nextLinked = *pFirst;
+    if (*pFirst != NULL) {
+        (*pFirst)->prevLinked = pIndex;
+    }
+    *pFirst = pIndex;
+}
+
+void ListIndex_unlink(ListIndex* pIndex, ListIndex** pFirst) {
+    if (pIndex->prevLinked != NULL) {
+        pIndex->prevLinked->nextLinked = pIndex->nextLinked;
+    }
+    else {
+        *pFirst = pIndex->nextLinked;
+    }
+    if (pIndex->nextLinked != NULL) {
+        pIndex->nextLinked->prevLinked = pIndex->prevLinked;
+    }
+}
+
+int ListIndex_reserve(ListIndex* pIndex, int additional) {
+    size_t needed = ((size_t)pIndex->count + additional) * 2;
+    size_t capacity = pIndex->mask + 1;
+    if (needed <= capacity) {
+        return 0;
+    }
+    while (capacity < needed) {
+        capacity <<= 1;
+    }
+    return resizeIndex(pIndex, capacity);
+}
+
+void ListIndex_insert(ListIndex* pIndex, Node* node) {
+    assert(((size_t)pIndex->count + 1) * 2 <= pIndex->mask + 1); // ListIndex_reserve first
+    placeEntry(pIndex->entries, pIndex->mask, mixHash(pIndex->pHash(node->data)), node);
+    pIndex->count++;
+}
+
+void ListIndex_remove(ListIndex* pIndex, Node* node) {
+    IndexEntry* entries = pIndex->entries;
+    size_t mask = pIndex->mask;
+    size_t slot = mixHash(pIndex->pHash(node->data)) & mask;
+    while (entries[slot].node != node) {
+        assert(entries[slot].node != NULL);
+        slot = (slot + 1) & mask;
+    }
+
+    // Shift back any later entry in the run whose home slot is at or before the hole
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; entries[next].node != NULL; next = (next + 1) & mask) {
+        size_t home = entries[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            entries[hole] = entries[next];
+            hole = next;
+        }
+    }
+    entries[hole].node = NULL;
+    pIndex->count--;
+}
+
+void ListIndex_replace(ListIndex* pIndex, Node* node, Node* replacement) {
+    size_t slot = mixHash(pIndex->pHash(node->data)) & pIndex->mask;
+    while (pIndex->entries[slot].node != node) {
+        assert(pIndex->entries[slot].node != NULL);
+        slot = (slot + 1) & pIndex->mask;
+    }
+    // The item, and so its hash and probe position, stays the same
+    pIndex->entries[slot].node = replacement;
+}
+
+Node* ListIndex_find(ListIndex* pIndex, void* pKey) {
+    size_t hash = mixHash(pIndex->pHash(pKey));
+    for (size_t slot = hash & pIndex->mask; pIndex->entries[slot].node != NULL; slot = (slot + 1) & pIndex->mask) {
+        IndexEntry* entry = &pIndex->entries[slot];
+        if (entry->hash == hash && pIndex->pEqual(entry->node->data, pKey)) {
+            return entry->node;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,42 @@
+// Hooks shared by the modules built on the list node pool.
+// Not part of the public API.
+
+#ifndef _LIST_INTERNAL_H_
+#define _LIST_INTERNAL_H_
+#include "list.h"
+#include "pool.h"
+
+// Returns the shared node pool, initializing it on first use.
+Pool* listNodePool(void);
+
+// Allocates a node index through the calling thread's magazine.
+// The node's contents are whatever its last user left. Returns -1 on failure.
+int listAllocNodeIndex(void);
+
+// Returns a node index through the calling thread's magazine. The node's
+// contents are left as they are.
+void listFreeNodeIndex(int nodeIndex);
+
+// Hash index behind List_enable_index. Callers reserve room before inserting,
+// so that a failed allocation can be reported before the list changes.
+ListIndex* ListIndex_create(HASH_FN pHash, COMPARATOR_FN pEqual);
+void ListIndex_destroy(ListIndex* pIndex);
+
+// Arenas keep the indexes of their lists on a list starting at *pFirst, so that
+// ListArena_reset can free them. The caller serializes these.
+void ListIndex_link(ListIndex* pIndex, ListIndex** pFirst);
+void ListIndex_unlink(ListIndex* pIndex, ListIndex** pFirst);
+int ListIndex_reserve(ListIndex* pIndex, int additional);
+void ListIndex_insert(ListIndex* pIndex, Node* node);
+void ListIndex_remove(ListIndex* pIndex, Node* node);
+Node* ListIndex_find(ListIndex* pIndex, void* pKey);
+
+// Points pIndex's entry for node at replacement instead, for a node whose item has
+// been copied to replacement. node's item must still be readable.
+void ListIndex_replace(ListIndex* pIndex, Node* node, Node* replacement);
+
+// Waits until every RCU read-side critical section running when it was called has
+// ended (see list_rcu.c). Not from inside one.
+void listRcuSynchronize(void);
+
+#endif
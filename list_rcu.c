@@ -0,0 +1,119 @@
+// Read-side critical sections and grace periods for lists in RCU mode (see
+// List_enable_rcu). Each reader thread has a slot holding the grace period it
+// saw on entering a critical section, or 0 outside one. A writer waits out a
+// grace period by starting a new one and waiting until no slot holds an older one.
+//
+// Readers only load the current grace period and store to their own slot. Where the
+// kernel has membarrier(2), the writer uses it to put a full barrier on every running
+// thread of the process, which orders those plain accesses against the list's links
+// and saves readers a fence of their own. Elsewhere readers take one fence on entry.
+
+#include "list.h"
+#include "list_internal.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __NR_membarrier
+#include <linux/membarrier.h>
+#endif
+
+typedef struct RcuReader_s RcuReader;
+struct RcuReader_s {
+    _Atomic uint64_t activePeriod; // Grace period seen on entry, 0 outside a critical section
+    int nesting;
+    bool registered;
+    RcuReader* nextRegistered; // Next live reader, under rcuLock
+};
+static _Thread_local RcuReader rcuReader;
+static pthread_key_t rcuReaderKey;
+
+static pthread_once_t rcuInitialized = PTHREAD_ONCE_INIT;
+static pthread_mutex_t rcuLock = PTHREAD_MUTEX_INITIALIZER; // Guards the reader list and serializes grace periods
+static RcuReader* registeredReaders = NULL;
+static _Atomic uint64_t gracePeriod = 1;
+static bool useMembarrier = false; // Set once, before any reader registers
+
+// Takes an exiting thread's slot off the reader list
+static void unregisterReader(void* reader) {
+    pthread_mutex_lock(&rcuLock);
+    RcuReader** link = &registeredReaders;
+    while (*link != reader) {
+        link = &(*link)->nextRegistered;
+    }
+    *link = ((RcuReader*)reader)->nextRegistered;
+    pthread_mutex_unlock(&rcuLock);
+    ((RcuReader*)reader)->registered = false;
+}
+
+static void initializeRcu(void) {
+    pthread_key_create(&rcuReaderKey, unregisterReader);
+#ifdef __NR_membarrier
+    useMembarrier = syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#endif
+}
+
+// Puts this thread's slot on the reader list, so that writers wait for it
+static void registerReader(RcuReader* reader) {
+    pthread_once(&rcuInitialized, initializeRcu);
+    pthread_setspecific(rcuReaderKey, reader);
+    pthread_mutex_lock(&rcuLock);
+    reader->nextRegistered = registeredReaders;
+    registeredReaders = reader;
+    pthread_mutex_unlock(&rcuLock);
+    reader->registered = true;
+}
+
+void List_rcu_read_lock(void) {
+    RcuReader* reader = &rcuReader;
+    if (reader->nesting++ > 0) {
+        return;
+    }
+    if (!reader->registered) {
+        registerReader(reader);
+    }
+    atomic_store_explicit(&reader->activePeriod,
+        atomic_load_explicit(&gracePeriod, memory_order_acquire), memory_order_relaxed);
+    // The slot must be visible before the list is read. With membarrier the writer
+    // supplies the barrier, so only the compiler needs holding back here.
+    if (useMembarrier) {
+        atomic_signal_fence(memory_order_seq_cst);
+    }
+    else {
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+void List_rcu_read_unlock(void) {
+    RcuReader* reader = &rcuReader;
+    assert(reader->nesting > 0);
+    if (--reader->nesting > 0) {
+        return;
+    }
+    // Release: every read of the list is done before a writer can see the slot clear
+    atomic_store_explicit(&reader->activePeriod, 0, memory_order_release);
+}
+
+// Waits until every read-side critical section that was running when this was called
+// has ended. Must not be called from inside one.
+void listRcuSynchronize(void) {
+    assert(rcuReader.nesting == 0);
+    pthread_once(&rcuInitialized, initializeRcu);
+
+    pthread_mutex_lock(&rcuLock);
+    uint64_t period = atomic_fetch_add(&gracePeriod, 1) + 1;
+#ifdef __NR_membarrier
+    if (useMembarrier) {
+        syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+    }
+#endif
+    for (RcuReader* reader = registeredReaders; reader != NULL; reader = reader->nextRegistered) {
+        uint64_t active;
+        while ((active = atomic_load_explicit(&reader->activePeriod, memory_order_acquire)) != 0 && active < period) {
+            sched_yield();
+        }
+    }
+    pthread_mutex_unlock(&rcuLock);
+}
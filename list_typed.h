@@ -0,0 +1,140 @@
+// Typed lists: LIST_DEFINE(name, T, matches) generates a list type name whose items are
+// T values, stored by value in their nodes, and name_ functions that mirror the List_
+// calls with the same cursor semantics. matches is a function or macro taking
+// (const T* item, const T* key) and returning whether they match. name_search calls it
+// directly rather than through a COMPARATOR_FN, so it is inlined into the search loop,
+// and each comparison reads the item from the node's own cache line.
+//
+//     static inline bool sameId(const Order* item, const Order* key) { return item->id == key->id; }
+//     LIST_DEFINE(OrderList, Order, sameId)
+//
+//     OrderList* orders = OrderList_create();
+//     OrderList_append(orders, (Order){ .id = 7, .qty = 3 });
+//     Order* found = OrderList_search(orders, (Order){ .id = 7 });
+//
+// A typed list is a List in an inline arena (see ListArena_create_inline) with a payload
+// of sizeof(T): name_create uses the process-wide one from ListArena_shared_inline, and
+// name_list gives the List itself for any call not generated here. Item pointers the
+// calls return point into the nodes and stay valid until the item is taken out.
+// Inline payloads are only 8-byte aligned, so T may not need more than that.
+// Not available with LIST_COMPACT_LINKS, where name_create returns NULL.
+
+#ifndef _LIST_TYPED_H_
+#define _LIST_TYPED_H_
+#include "list.h"
+
+#define LIST_DEFINE(name, T, matches) \
+\
+_Static_assert(_Alignof(T) <= 8, "inline list items are only 8-byte aligned"); \
+\
+typedef struct name##_s name; \
+\
+static inline List* name##_list(name* pList) { \
+    return (List*)pList; \
+} \
+\
+/* Makes a new, empty list in the shared arena for T. Returns NULL on failure. */ \
+static inline name* name##_create(void) { \
+    ListArena* arena = ListArena_shared_inline(sizeof(T)); \
+    return arena != NULL ? (name*)List_create_in(arena) : NULL; \
+} \
+\
+/* Makes a new, empty list in arena, whose payload size must be sizeof(T). */ \
+static inline name* name##_create_in(ListArena* arena) { \
+    return (name*)List_create_in(arena); \
+} \
+\
+static inline int name##_count(name* pList) { \
+    return List_count(name##_list(pList)); \
+} \
+\
+static inline T* name##_first(name* pList) { \
+    return (T*)List_first(name##_list(pList)); \
+} \
+\
+static inline T* name##_last(name* pList) { \
+    return (T*)List_last(name##_list(pList)); \
+} \
+\
+static inline T* name##_next(name* pList) { \
+    return (T*)List_next(name##_list(pList)); \
+} \
+\
+static inline T* name##_prev(name* pList) { \
+    return (T*)List_prev(name##_list(pList)); \
+} \
+\
+static inline T* name##_curr(name* pList) { \
+    return (T*)List_curr(name##_list(pList)); \
+} \
+\
+/* The inserts copy item into its new node. Returns 0 on success, -1 on failure. */ \
+static inline int name##_insert_after(name* pList, T item) { \
+    return List_insert_after_copy(name##_list(pList), &item); \
+} \
+\
+static inline int name##_insert_before(name* pList, T item) { \
+    return List_insert_before_copy(name##_list(pList), &item); \
+} \
+\
+static inline int name##_append(name* pList, T item) { \
+    return List_append_copy(name##_list(pList), &item); \
+} \
+\
+static inline int name##_prepend(name* pList, T item) { \
+    return List_prepend_copy(name##_list(pList), &item); \
+} \
+\
+/* Takes out the current (or last) item, copying it to pOut if that is not NULL. \
+   Returns 0 on success, -1 if there is no item to take out. */ \
+static inline int name##_remove(name* pList, T* pOut) { \
+    return List_remove_copy(name##_list(pList), pOut); \
+} \
+\
+static inline int name##_trim(name* pList, T* pOut) { \
+    return List_trim_copy(name##_list(pList), pOut); \
+} \
+\
+static inline void name##_concat(name* pList1, name* pList2) { \
+    List_concat(name##_list(pList1), name##_list(pList2)); \
+} \
+\
+static inline void name##_free(name* pList) { \
+    List_free(name##_list(pList), NULL); \
+} \
+\
+static inline bool name##_matchesItem(void* pItem, void* pComparisonArg) { \
+    return matches((const T*)pItem, (const T*)pComparisonArg); \
+} \
+\
+/* Searches from the current item for one that matches key, as List_search does. */ \
+static inline T* name##_search(name* pList, T key) { \
+    LIST_TYPED_SEARCH(name, T, matches, pList, key) \
+}
+
+#ifdef LIST_COMPACT_LINKS
+// Compact links need list.c to decode them; typed lists cannot be made in this build anyway
+#define LIST_TYPED_SEARCH(name, T, matches, pList, key) \
+    return (T*)List_search(name##_list(pList), name##_matchesItem, &key);
+#else
+// Follows a pointer link the way list.c does, for the lookahead
+static inline Node* listTypedNext(Node* node) {
+    return __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+}
+
+#define LIST_TYPED_SEARCH(name, T, matches, pList, key) \
+    List* list = name##_list(pList); \
+    Node* node = List_search_start(list); \
+    Node* ahead = List_lookahead_start(node, listTypedNext); \
+    int visited = 0; \
+    for (; node != NULL; node = listTypedNext(node)) { \
+        ahead = List_lookahead_advance(ahead, listTypedNext); \
+        visited++; \
+        if (matches((const T*)node->data, &key)) { \
+            break; \
+        } \
+    } \
+    return (T*)List_search_finish(list, node, visited);
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+#include "lru.h"
+#include <assert.h>
+#include <stdlib.h>
+
+struct ListLru_s {
+    List* list;       // Most recently used first, with a hash index
+    int capacity;
+    EVICT_FN pEvict;
+    void* pEvictArg;
+};
+
+// Makes a new, empty cache of up to capacity items. Returns a NULL pointer on failure.
+ListLru* ListLru_create(int capacity, HASH_FN pHash, COMPARATOR_FN pEqual, EVICT_FN pEvict, void* pEvictArg) {
+    assert(capacity > 0 && pHash != NULL && pEqual != NULL);
+
+    ListLru* pLru = malloc(sizeof(ListLru));
+    if (pLru == NULL) {
+        return NULL;
+    }
+    pLru->list = List_create();
+    if (pLru->list == NULL || List_enable_index(pLru->list, pHash, pEqual) != 0) {
+        if (pLru->list != NULL) {
+            List_free(pLru->list, NULL);
+        }
+        free(pLru);
+        return NULL;
+    }
+    pLru->capacity = capacity;
+    pLru->pEvict = pEvict;
+    pLru->pEvictArg = pEvictArg;
+    return pLru;
+}
+
+// Hands an item the cache has let go of to the eviction callback
+static void evicted(ListLru* pLru, void* pItem) {
+    if (pLru->pEvict != NULL) {
+        pLru->pEvict(pItem, pLru->pEvictArg);
+    }
+}
+
+// Returns the item matching pKey, making it the most recently used, or NULL.
+void* ListLru_get(ListLru* pLru, void* pKey) {
+    assert(pLru != NULL);
+
+    void* pItem = List_find_key(pLru->list, pKey);
+    if (pItem != NULL) {
+        List_move_to_front(pLru->list);
+    }
+    return pItem;
+}
+
+// Returns the item matching pKey, or NULL, without touching it.
+void* ListLru_peek(ListLru* pLru, void* pKey) {
+    assert(pLru != NULL);
+
+    return List_find_key(pLru->list, pKey);
+}
+
+// Makes the item matching pKey the most recently used. Returns 0 on success, -1 if absent.
+int ListLru_touch(ListLru* pLru, void* pKey) {
+    return ListLru_get(pLru, pKey) != NULL ? 0 : -1;
+}
+
+// Adds pItem as the most recently used item, replacing any item with its key and evicting
+// the least recently used one if the cache is over capacity. Returns 0 on success, -1 on failure.
+int ListLru_put(ListLru* pLru, void* pItem) {
+    assert(pLru != NULL && pItem != NULL);
+
+    List* pList = pLru->list;
+    void* pOld = List_find_key(pList, pItem);
+    if (pOld != NULL) {
+        // Bring the old item to the front; putting an item that is already cached ends there
+        List_move_to_front(pList);
+        if (pOld == pItem) {
+            return 0;
+        }
+    }
+    if (List_prepend(pList, pItem) != LIST_SUCCESS) {
+        return -1;
+    }
+    if (pOld != NULL) {
+        List_next(pList);
+        List_remove(pList);
+        evicted(pLru, pOld);
+    }
+    else if (List_count(pList) > pLru->capacity) {
+        evicted(pLru, List_trim(pList));
+    }
+    return 0;
+}
+
+// Takes the item matching pKey out of the cache and returns it, or returns NULL.
+void* ListLru_remove(ListLru* pLru, void* pKey) {
+    assert(pLru != NULL);
+
+    void* pItem = List_find_key(pLru->list, pKey);
+    if (pItem != NULL) {
+        List_remove(pLru->list);
+    }
+    return pItem;
+}
+
+// Evicts the least recently used item. Returns 0 on success, -1 if the cache is empty.
+int ListLru_evict(ListLru* pLru) {
+    assert(pLru != NULL);
+
+    if (List_count(pLru->list) == 0) {
+        return -1;
+    }
+    evicted(pLru, List_trim(pLru->list));
+    return 0;
+}
+
+// Returns the number of items in pLru.
+int ListLru_count(ListLru* pLru) {
+    return List_count(pLru->list);
+}
+
+// Returns the list behind pLru, most recently used first.
+List* ListLru_list(ListLru* pLru) {
+    return pLru->list;
+}
+
+// Delete pLru, invoking pItemFreeFn on every item still cached.
+void ListLru_free(ListLru* pLru, FREE_FN pItemFreeFn) {
+    assert(pLru != NULL);
+
+    List_free(pLru->list, pItemFreeFn);
+    free(pLru);
+}
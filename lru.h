@@ -0,0 +1,59 @@
+// LRU cache: a List kept in recency order, most recently used first, with a hash index
+// over it. Lookups go through the index and a hit moves its node to the front without
+// releasing it, so get, put, touch and evict all take O(1) expected time. Items carry
+// their own keys, as for List_enable_index: pHash and pEqual see items, and a key is an
+// item with only its key fields filled in.
+//
+// Like a List, a cache is not synchronized; share one between threads only under your
+// own lock.
+
+#ifndef _LRU_H_
+#define _LRU_H_
+#include "list.h"
+
+typedef struct ListLru_s ListLru;
+
+// Called with each item the cache lets go of by itself: evicted to make room, evicted by
+// ListLru_evict, or replaced by ListLru_put. pArg is the one given to ListLru_create.
+typedef void (*EVICT_FN)(void* pItem, void* pArg);
+
+// Makes a new, empty cache holding up to capacity items. pEvict may be NULL.
+// Returns a NULL pointer on failure.
+ListLru* ListLru_create(int capacity, HASH_FN pHash, COMPARATOR_FN pEqual, EVICT_FN pEvict, void* pEvictArg);
+
+// Returns the item matching pKey and makes it the most recently used, or returns NULL if
+// there is none.
+void* ListLru_get(ListLru* pLru, void* pKey);
+
+// Returns the item matching pKey, or NULL, leaving the order alone.
+void* ListLru_peek(ListLru* pLru, void* pKey);
+
+// Makes the item matching pKey the most recently used. Returns 0 on success, -1 if there
+// is no such item.
+int ListLru_touch(ListLru* pLru, void* pKey);
+
+// Adds pItem as the most recently used item. An item with the same key is replaced, and a
+// full cache first evicts its least recently used item; either goes to pEvict.
+// Putting an item that is already cached only makes it the most recently used.
+// Returns 0 on success, -1 on failure (with the cache unchanged but for any eviction).
+int ListLru_put(ListLru* pLru, void* pItem);
+
+// Takes the item matching pKey out of the cache and returns it (pEvict is not called),
+// or returns NULL if there is none.
+void* ListLru_remove(ListLru* pLru, void* pKey);
+
+// Evicts the least recently used item, passing it to pEvict. Returns 0 on success, -1 if
+// the cache is empty.
+int ListLru_evict(ListLru* pLru);
+
+// Returns the number of items in pLru.
+int ListLru_count(ListLru* pLru);
+
+// Returns the list behind pLru, most recently used first, for walking it (with a ListIter,
+// say). Changing it other than through ListLru_ calls breaks the cache.
+List* ListLru_list(ListLru* pLru);
+
+// Delete pLru, invoking pItemFreeFn on every item still cached (if it is not NULL).
+void ListLru_free(ListLru* pLru, FREE_FN pItemFreeFn);
+
+#endif
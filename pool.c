@@ -0,0 +1,318 @@
+#include "pool.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Maps a zeroed block of bytes aligned to align (a power of two). Over-maps by
+// align and unmaps the slack on either side, so no physical memory is wasted.
+static char* mapAligned(size_t bytes, size_t align) {
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t length = (bytes + pageSize - 1) & ~(pageSize - 1);
+    if (align < pageSize) {
+        align = pageSize;
+    }
+
+    char* raw = mmap(NULL, length + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    char* block = (char*)(((uintptr_t)raw + align - 1) & ~(uintptr_t)(align - 1));
+    if (block > raw) {
+        munmap(raw, block - raw);
+    }
+    if (raw + length + align > block + length) {
+        munmap(block + length, raw + length + align - (block + length));
+    }
+    return block;
+}
+
+size_t Pool_slabBytesFor(size_t stride) {
+    size_t slabBytes = 1;
+    while (slabBytes < POOL_SLAB_HEADER + POOL_SLAB_SIZE * stride) {
+        slabBytes <<= 1;
+    }
+    return slabBytes;
+}
+
+void Pool_initShared(Pool* pool, size_t stride, PoolDirectory* directory) {
+    assert(stride > 0);
+
+    pool->stride = stride;
+    pool->slabBytes = Pool_slabBytesFor(stride);
+
+    // Split stride into odd << shift and invert the odd part (Newton's iteration
+    // doubles the number of correct low bits each step)
+    pool->strideShift = 0;
+    while (((stride >> pool->strideShift) & 1) == 0) {
+        pool->strideShift++;
+    }
+    uint32_t odd = (uint32_t)(stride >> pool->strideShift);
+    uint32_t inv = odd;
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - odd * inv;
+    }
+    pool->strideInv = inv;
+
+    pool->directory = directory;
+    pool->slabs = NULL;
+    pool->slabNumbers = NULL;
+    pool->numSlabs = 0;
+    pool->bump = 0;
+    pool->freeStack = NULL;
+    pool->freeTop = -1;
+    pool->numInUse = 0;
+    pool->highWater = 0;
+    pool->allocFailures = 0;
+    pool->fixedMemory = NULL;
+}
+
+void Pool_init(Pool* pool, size_t stride) {
+    pool->ownDirectory = (PoolDirectory)POOL_DIRECTORY_INITIALIZER;
+    Pool_initShared(pool, stride, &pool->ownDirectory);
+}
+
+// Takes a free slab number from the directory and records slab under it.
+// Returns the number, or -1 if the directory is full.
+static int addToDirectory(PoolDirectory* directory, char* slab) {
+    pthread_mutex_lock(&directory->lock);
+    int number = -1;
+    if (directory->slabs == NULL) {
+        directory->slabs = calloc(POOL_MAX_SLABS, sizeof(char*));
+    }
+    if (directory->slabs != NULL) {
+        if (directory->numFree > 0) {
+            number = directory->freeNumbers[--directory->numFree];
+        }
+        else if (directory->numSlabs < POOL_MAX_SLABS) {
+            number = directory->numSlabs++;
+        }
+    }
+    if (number >= 0) {
+        directory->slabs[number] = slab;
+    }
+    pthread_mutex_unlock(&directory->lock);
+    return number;
+}
+
+// Adds one slab to the pool. Returns 0 on success, -1 on failure.
+static int growPool(Pool* pool) {
+    if (pool->numSlabs == POOL_MAX_SLABS || pool->fixedMemory != NULL) {
+        return -1;
+    }
+
+    // Keep the free stack large enough to hold every index, so Pool_free never fails
+    int newCapacity = (pool->numSlabs + 1) << POOL_SLAB_SHIFT;
+    int* freeStack = realloc(pool->freeStack, newCapacity * sizeof(int));
+    if (freeStack == NULL) {
+        return -1;
+    }
+    pool->freeStack = freeStack;
+    int* slabNumbers = realloc(pool->slabNumbers, (pool->numSlabs + 1) * sizeof(int));
+    if (slabNumbers == NULL) {
+        return -1;
+    }
+    pool->slabNumbers = slabNumbers;
+
+    char* slab = mapAligned(pool->slabBytes, pool->slabBytes);
+    if (slab == NULL) {
+        return -1;
+    }
+    int number = addToDirectory(pool->directory, slab);
+    if (number < 0) {
+        munmap(slab, pool->slabBytes);
+        return -1;
+    }
+    *(int*)slab = number;
+    // Set once: other threads may be reading it in Pool_at, without the caller's lock
+    if (pool->slabs != pool->directory->slabs) {
+        pool->slabs = pool->directory->slabs;
+    }
+    pool->slabNumbers[pool->numSlabs++] = number;
+    return 0;
+}
+
+// Numbers the fixed pool's slabs in its directory, writing each number to the slab header
+// and to slabNumbers. Returns 0 on success, -1 (with no slab numbered) if the directory is full.
+static int numberFixedSlabs(Pool* pool) {
+    for (int i = 0; i < pool->numSlabs; i++) {
+        char* slab = pool->fixedMemory + (size_t)i * pool->slabBytes;
+        int number = addToDirectory(pool->directory, slab);
+        if (number < 0) {
+            int numSlabs = pool->numSlabs;
+            pool->numSlabs = i;
+            Pool_detach(pool);
+            pool->numSlabs = numSlabs;
+            return -1;
+        }
+        *(int*)slab = number;
+        pool->slabNumbers[i] = number;
+    }
+    pool->slabs = pool->directory->slabs;
+    return 0;
+}
+
+int Pool_initFixed(Pool* pool, size_t stride, PoolDirectory* directory, char* memory, int numSlabs,
+    int* slabNumbers, int* freeStack) {
+    assert(memory != NULL && ((uintptr_t)memory & (Pool_slabBytesFor(stride) - 1)) == 0);
+    assert(numSlabs > 0 && numSlabs <= POOL_MAX_SLABS);
+
+    Pool_initShared(pool, stride, directory);
+    pool->fixedMemory = memory;
+    pool->slabNumbers = slabNumbers;
+    pool->freeStack = freeStack;
+    pool->numSlabs = numSlabs;
+    return numberFixedSlabs(pool);
+}
+
+void Pool_detach(Pool* pool) {
+    assert(pool->fixedMemory != NULL);
+
+    PoolDirectory* directory = pool->directory;
+    pthread_mutex_lock(&directory->lock);
+    if (directory->freeNumbers == NULL && pool->numSlabs > 0) {
+        directory->freeNumbers = malloc(POOL_MAX_SLABS * sizeof(int));
+    }
+    for (int i = 0; i < pool->numSlabs; i++) {
+        directory->slabs[pool->slabNumbers[i]] = NULL;
+        if (directory->freeNumbers != NULL) {
+            directory->freeNumbers[directory->numFree++] = pool->slabNumbers[i];
+        }
+    }
+    pthread_mutex_unlock(&directory->lock);
+}
+
+int Pool_reattach(Pool* pool, PoolDirectory* directory) {
+    assert(pool->fixedMemory != NULL);
+
+    // Free indices carry the old slab numbers; remember which slab each number meant,
+    // and the numbers themselves in case the directory is full
+    int* oldToSlab = malloc(POOL_MAX_SLABS * sizeof(int));
+    int* oldNumbers = malloc(pool->numSlabs * sizeof(int));
+    if (oldToSlab == NULL || oldNumbers == NULL) {
+        free(oldToSlab);
+        free(oldNumbers);
+        return -1;
+    }
+    for (int i = 0; i < pool->numSlabs; i++) {
+        oldToSlab[pool->slabNumbers[i]] = i;
+        oldNumbers[i] = pool->slabNumbers[i];
+    }
+
+    pool->directory = directory;
+    if (numberFixedSlabs(pool) != 0) {
+        memcpy(pool->slabNumbers, oldNumbers, pool->numSlabs * sizeof(int));
+        free(oldToSlab);
+        free(oldNumbers);
+        return -1;
+    }
+    for (int i = 0; i <= pool->freeTop; i++) {
+        int index = pool->freeStack[i];
+        int slab = oldToSlab[index >> POOL_SLAB_SHIFT];
+        pool->freeStack[i] = (pool->slabNumbers[slab] << POOL_SLAB_SHIFT) | (index & (POOL_SLAB_SIZE - 1));
+    }
+    free(oldToSlab);
+    free(oldNumbers);
+    return 0;
+}
+
+int Pool_alloc(Pool* pool) {
+    int index;
+    if (pool->freeTop >= 0) {
+        // Reuse the most recently released object
+        index = pool->freeStack[pool->freeTop--];
+    }
+    else {
+        if (pool->bump == Pool_capacity(pool) && growPool(pool) != 0) {
+            pool->allocFailures++;
+            return -1;
+        }
+        index = (pool->slabNumbers[pool->bump >> POOL_SLAB_SHIFT] << POOL_SLAB_SHIFT)
+            | (pool->bump & (POOL_SLAB_SIZE - 1));
+        pool->bump++;
+    }
+    if (++pool->numInUse > pool->highWater) {
+        pool->highWater = pool->numInUse;
+    }
+    return index;
+}
+
+int Pool_allocRun(Pool* pool, int maxCount, int* pFirst) {
+    assert(maxCount > 0);
+
+    if (pool->bump == Pool_capacity(pool) && growPool(pool) != 0) {
+        pool->allocFailures++;
+        return -1;
+    }
+    int slot = pool->bump & (POOL_SLAB_SIZE - 1);
+    int count = POOL_SLAB_SIZE - slot < maxCount ? POOL_SLAB_SIZE - slot : maxCount;
+    *pFirst = (pool->slabNumbers[pool->bump >> POOL_SLAB_SHIFT] << POOL_SLAB_SHIFT) | slot;
+    pool->bump += count;
+    pool->numInUse += count;
+    if (pool->numInUse > pool->highWater) {
+        pool->highWater = pool->numInUse;
+    }
+    return count;
+}
+
+void Pool_free(Pool* pool, int index) {
+    assert(index >= 0 && pool->numInUse > 0);
+    pool->freeStack[++pool->freeTop] = index;
+    pool->numInUse--;
+}
+
+int Pool_allocBatch(Pool* pool, int* indices, int count) {
+    int allocated = 0;
+    while (allocated < count) {
+        int index = Pool_alloc(pool);
+        if (index < 0) {
+            break;
+        }
+        indices[allocated++] = index;
+    }
+    return allocated;
+}
+
+void Pool_freeBatch(Pool* pool, const int* indices, int count) {
+    for (int i = 0; i < count; i++) {
+        Pool_free(pool, indices[i]);
+    }
+}
+
+void Pool_reset(Pool* pool) {
+    pool->bump = 0;
+    pool->freeTop = -1;
+    pool->numInUse = 0;
+}
+
+void Pool_destroy(Pool* pool) {
+    assert(pool->fixedMemory == NULL);
+
+    PoolDirectory* directory = pool->directory;
+    pthread_mutex_lock(&directory->lock);
+    if (directory->freeNumbers == NULL && pool->numSlabs > 0) {
+        directory->freeNumbers = malloc(POOL_MAX_SLABS * sizeof(int));
+    }
+    for (int i = 0; i < pool->numSlabs; i++) {
+        int number = pool->slabNumbers[i];
+        munmap(directory->slabs[number], pool->slabBytes);
+        directory->slabs[number] = NULL;
+        if (directory->freeNumbers != NULL) {
+            directory->freeNumbers[directory->numFree++] = number;
+        }
+    }
+    pthread_mutex_unlock(&directory->lock);
+    if (directory == &pool->ownDirectory) {
+        free(directory->slabs);
+        free(directory->freeNumbers);
+        pthread_mutex_destroy(&directory->lock);
+    }
+
+    free(pool->slabNumbers);
+    free(pool->freeStack);
+    Pool_initShared(pool, pool->stride, directory);
+    if (directory == &pool->ownDirectory) {
+        pool->ownDirectory = (PoolDirectory)POOL_DIRECTORY_INITIALIZER;
+    }
+}
@@ -0,0 +1,134 @@
+// Slab-backed object pool used for list nodes and list heads.
+// Objects are handed out as integer indices. The pool grows on demand one slab
+// at a time, and slabs are never moved, so a pointer to a pooled object stays
+// valid for the life of the pool. Slabs are only unmapped by Pool_destroy.
+//
+// An index is a slab number from the pool's directory and a slot within that
+// slab. Several pools may share one directory, which makes their indices
+// unique across all of them (list nodes rely on this for compact links).
+
+#ifndef _POOL_H_
+#define _POOL_H_
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Objects per slab (log2)
+#define POOL_SLAB_SHIFT 12
+#define POOL_SLAB_SIZE (1 << POOL_SLAB_SHIFT)
+
+// Size of the slab directory; caps a pool at POOL_MAX_SLABS * POOL_SLAB_SIZE objects
+#define POOL_MAX_SLABS (1 << 15)
+
+// Every slab starts with a header (padded to a cache line) that records its
+// position in the directory, so an object's index can be recovered from its address.
+#define POOL_SLAB_HEADER 64
+
+// Maps slab numbers to slabs. Numbers released by Pool_destroy are reused.
+typedef struct PoolDirectory_s PoolDirectory;
+struct PoolDirectory_s {
+    char** slabs;       // POOL_MAX_SLABS entries, allocated on first use and never moved
+    int numSlabs;       // Slab numbers handed out so far
+    int* freeNumbers;   // Slab numbers given back, for reuse
+    int numFree;
+    pthread_mutex_t lock;
+};
+#define POOL_DIRECTORY_INITIALIZER { NULL, 0, NULL, 0, PTHREAD_MUTEX_INITIALIZER }
+
+typedef struct Pool_s Pool;
+struct Pool_s {
+    size_t stride;      // Bytes per object
+    size_t slabBytes;   // Size and alignment of a slab (a power of two)
+    int strideShift;    // stride == strideOdd << strideShift
+    uint32_t strideInv; // Inverse of strideOdd mod 2^32, for exact division
+    PoolDirectory* directory;
+    PoolDirectory ownDirectory; // Used unless the pool was set up with a shared directory
+    char** slabs;       // directory->slabs, cached
+    int* slabNumbers;   // This pool's slabs, in the order they were added
+    int numSlabs;
+    int bump;           // Objects handed out from never-used space, counted across this pool's slabs in order
+    int* freeStack;     // Stack of released indices, sized to the pool capacity
+    int freeTop;        // -1 when the stack is empty
+    int numInUse;
+    int highWater;      // Most objects ever in use at once
+    uint64_t allocFailures; // Pool_alloc calls that returned -1
+    char* fixedMemory;  // Slabs of a pool made by Pool_initFixed, NULL otherwise
+};
+
+// Sets up an empty pool for objects of the given size. No memory is reserved
+// until the first allocation.
+void Pool_init(Pool* pool, size_t stride);
+
+// Same as Pool_init, but takes slab numbers from directory, which may be shared
+// with other pools.
+void Pool_initShared(Pool* pool, size_t stride, PoolDirectory* directory);
+
+// Size and alignment of one slab for objects of the given size.
+size_t Pool_slabBytesFor(size_t stride);
+
+// Sets up a pool of numSlabs slabs over memory the caller provides and keeps: the slabs
+// themselves, consecutive at memory (aligned to Pool_slabBytesFor(stride)), an array of
+// numSlabs slab numbers and a free stack of numSlabs * POOL_SLAB_SIZE entries. The pool
+// never grows. Returns 0 on success, or -1 if the directory is full.
+int Pool_initFixed(Pool* pool, size_t stride, PoolDirectory* directory, char* memory, int numSlabs,
+    int* slabNumbers, int* freeStack);
+
+// Gives a fixed pool's slab numbers back to its directory, leaving the pool and its memory
+// as they are so that Pool_reattach can take it up again (in this process or, if the
+// memory is a file mapped at the same address, in another one).
+void Pool_detach(Pool* pool);
+
+// Numbers a detached fixed pool's slabs in directory again, and renumbers the indices on
+// its free stack to match. Returns 0 on success, or -1 if the directory is full.
+int Pool_reattach(Pool* pool, PoolDirectory* directory);
+
+// Makes every object free again in O(1) time, keeping the slabs for reuse.
+// Objects are handed out again in their original order.
+void Pool_reset(Pool* pool);
+
+// Unmaps the pool's slabs and returns their numbers to the directory.
+// The pool is left empty and may be used again. Not for fixed pools (see Pool_detach).
+void Pool_destroy(Pool* pool);
+
+// Returns the index of a free object, growing the pool by a slab if needed.
+// Returns -1 when the pool cannot grow.
+int Pool_alloc(Pool* pool);
+
+// Takes up to maxCount objects from never-used space, all in one slab, so their
+// indices (and addresses) are consecutive. Returns how many were taken, with the
+// first index in *pFirst, or -1 when the pool cannot grow. Released objects are
+// left for Pool_alloc.
+int Pool_allocRun(Pool* pool, int maxCount, int* pFirst);
+
+// Returns an object to the pool. Never fails.
+void Pool_free(Pool* pool, int index);
+
+// Allocates up to count indices into indices. Returns how many were allocated,
+// which is less than count only when the pool cannot grow.
+int Pool_allocBatch(Pool* pool, int* indices, int count);
+
+// Returns count objects to the pool.
+void Pool_freeBatch(Pool* pool, const int* indices, int count);
+
+// Maps an index to its object.
+static inline void* Pool_at(Pool* pool, int index) {
+    return pool->slabs[index >> POOL_SLAB_SHIFT] + POOL_SLAB_HEADER
+        + (size_t)(index & (POOL_SLAB_SIZE - 1)) * pool->stride;
+}
+
+// Maps an object back to its index.
+static inline int Pool_indexOf(Pool* pool, void* obj) {
+    char* slab = (char*)((uintptr_t)obj & ~(uintptr_t)(pool->slabBytes - 1));
+    uint32_t offset = (uint32_t)((char*)obj - slab - POOL_SLAB_HEADER);
+    // offset is an exact multiple of stride, so multiplying by the inverse of its
+    // odd part divides without a hardware divide
+    uint32_t slot = (offset >> pool->strideShift) * pool->strideInv;
+    return (*(int*)slab << POOL_SLAB_SHIFT) | (int)slot;
+}
+
+// Number of objects the pool can hold without growing.
+static inline int Pool_capacity(Pool* pool) {
+    return pool->numSlabs << POOL_SLAB_SHIFT;
+}
+
+#endif
@@ -0,0 +1,257 @@
+// Michael-Scott queue over pool node indices.
+//
+// The head, the tail and every node's next link are 64-bit words holding a
+// 32-bit node index and a 32-bit tag. Each successful CAS bumps the tag, so a
+// node that is dequeued, recycled through the pool and enqueued again cannot be
+// mistaken for its earlier self (the ABA problem). Pool memory is never unmapped,
+// so a thread holding a stale index can still safely read the node behind it.
+//
+// The tag only works if nothing else writes the word it lives in, so queue nodes
+// have a pool of their own rather than sharing the list node pool, whose users
+// overwrite a node's links (and with them the tag) whenever they take it.
+
+#include "queue.h"
+#include "pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define QUEUE_NIL UINT32_MAX
+
+typedef struct QueueNode_s QueueNode;
+struct QueueNode_s {
+    _Atomic(void*) data;
+    _Atomic uint64_t next;
+};
+
+// Magazine capacity, and how many indices move between a magazine and the pool at once
+#define QUEUE_MAGAZINE_SIZE 64
+#define QUEUE_MAGAZINE_BATCH 32
+
+// Each thread keeps a magazine of free node indices in front of the pool, as list
+// nodes do, so most enqueues and dequeues take no lock
+typedef struct QueueMagazine_s QueueMagazine;
+struct QueueMagazine_s {
+    int count;
+    bool registered; // Whether the thread-exit flush is set up for this thread
+    int indices[QUEUE_MAGAZINE_SIZE];
+};
+static _Thread_local QueueMagazine queueMagazine;
+static pthread_key_t queueMagazineKey;
+
+static Pool queueNodePool;
+static pthread_mutex_t queuePoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t queuePoolInitialized = PTHREAD_ONCE_INIT;
+
+// Head, tail and count each get their own cache line so producers and
+// consumers don't invalidate each other's lines
+struct ListQueue_s {
+    _Alignas(64) _Atomic uint64_t head;
+    _Alignas(64) _Atomic uint64_t tail;
+    _Alignas(64) _Atomic int count;
+    Pool* pool;
+};
+
+static inline uint64_t makeLink(uint32_t index, uint32_t tag) {
+    return ((uint64_t)tag << 32) | index;
+}
+
+static inline uint32_t linkIndex(uint64_t link) {
+    return (uint32_t)link;
+}
+
+static inline uint32_t linkTag(uint64_t link) {
+    return (uint32_t)(link >> 32);
+}
+
+static inline QueueNode* queueNode(ListQueue* pQueue, uint32_t index) {
+    return Pool_at(pQueue->pool, (int)index);
+}
+
+// Hands a thread's cached node indices back to the pool when the thread exits
+static void flushQueueMagazine(void* magazine) {
+    QueueMagazine* pMagazine = magazine;
+    pthread_mutex_lock(&queuePoolLock);
+    Pool_freeBatch(&queueNodePool, pMagazine->indices, pMagazine->count);
+    pthread_mutex_unlock(&queuePoolLock);
+    pMagazine->count = 0;
+    pMagazine->registered = false;
+}
+
+// Slabs are mapped zeroed, so every node starts out with tag 0
+static void initializeQueuePool() {
+    Pool_init(&queueNodePool, sizeof(QueueNode));
+    pthread_key_create(&queueMagazineKey, flushQueueMagazine);
+}
+
+// Returns this thread's magazine, arranging for it to be flushed when the thread exits
+static QueueMagazine* currentQueueMagazine(void) {
+    QueueMagazine* pMagazine = &queueMagazine;
+    if (!pMagazine->registered) {
+        pthread_setspecific(queueMagazineKey, pMagazine);
+        pMagazine->registered = true;
+    }
+    return pMagazine;
+}
+
+// Pops a free node index off this thread's magazine, refilling it from the pool if
+// it is empty. Returns -1 if the pool cannot grow.
+static int allocQueueNodeIndex(void) {
+    QueueMagazine* pMagazine = currentQueueMagazine();
+    if (pMagazine->count == 0) {
+        pthread_mutex_lock(&queuePoolLock);
+        pMagazine->count = Pool_allocBatch(&queueNodePool, pMagazine->indices, QUEUE_MAGAZINE_BATCH);
+        pthread_mutex_unlock(&queuePoolLock);
+        if (pMagazine->count == 0) {
+            return -1;
+        }
+    }
+    return pMagazine->indices[--pMagazine->count];
+}
+
+// Pushes a node index onto this thread's magazine, spilling a batch to the pool if it
+// is full. The node's contents, and so its tag, are left as they are.
+static void freeQueueNodeIndex(int nodeIndex) {
+    QueueMagazine* pMagazine = currentQueueMagazine();
+    if (pMagazine->count == QUEUE_MAGAZINE_SIZE) {
+        pMagazine->count -= QUEUE_MAGAZINE_BATCH;
+        pthread_mutex_lock(&queuePoolLock);
+        Pool_freeBatch(&queueNodePool, &pMagazine->indices[pMagazine->count], QUEUE_MAGAZINE_BATCH);
+        pthread_mutex_unlock(&queuePoolLock);
+    }
+    pMagazine->indices[pMagazine->count++] = nodeIndex;
+}
+
+// Makes a new, empty queue, and returns its reference on success.
+// Returns a NULL pointer on failure.
+ListQueue* ListQueue_create() {
+    ListQueue* pQueue = aligned_alloc(64, sizeof(ListQueue));
+    if (pQueue == NULL) {
+        return NULL;
+    }
+    pthread_once(&queuePoolInitialized, initializeQueuePool);
+    pQueue->pool = &queueNodePool;
+
+    // The queue always holds one dummy node; head points at it
+    int dummyIndex = allocQueueNodeIndex();
+    if (dummyIndex < 0) {
+        free(pQueue);
+        return NULL;
+    }
+    QueueNode* dummy = queueNode(pQueue, dummyIndex);
+    atomic_store_explicit(&dummy->data, NULL, memory_order_relaxed);
+    atomic_store_explicit(&dummy->next, makeLink(QUEUE_NIL, 0), memory_order_relaxed);
+
+    atomic_init(&pQueue->head, makeLink(dummyIndex, 0));
+    atomic_init(&pQueue->tail, makeLink(dummyIndex, 0));
+    atomic_init(&pQueue->count, 0);
+    return pQueue;
+}
+
+// Adds pItem to the back of pQueue.
+// Returns 0 on success, -1 on failure.
+int ListQueue_enqueue(ListQueue* pQueue, void* pItem) {
+    assert(pQueue != NULL && pItem != NULL);
+
+    int nodeIndex = allocQueueNodeIndex();
+    if (nodeIndex < 0) {
+        return -1;
+    }
+    QueueNode* node = queueNode(pQueue, nodeIndex);
+    atomic_store_explicit(&node->data, pItem, memory_order_relaxed);
+    uint64_t oldNext = atomic_load_explicit(&node->next, memory_order_relaxed);
+    atomic_store_explicit(&node->next, makeLink(QUEUE_NIL, linkTag(oldNext) + 1), memory_order_relaxed);
+
+    uint64_t tail;
+    for (;;) {
+        tail = atomic_load_explicit(&pQueue->tail, memory_order_acquire);
+        QueueNode* tailNode = queueNode(pQueue, linkIndex(tail));
+        uint64_t next = atomic_load_explicit(&tailNode->next, memory_order_acquire);
+        if (tail != atomic_load_explicit(&pQueue->tail, memory_order_acquire)) {
+            continue; // tail moved while we read it
+        }
+        if (linkIndex(next) == QUEUE_NIL) {
+            // Link the new node after the last one; the release publishes its data
+            uint64_t newNext = makeLink(nodeIndex, linkTag(next) + 1);
+            if (atomic_compare_exchange_weak_explicit(&tailNode->next, &next, newNext,
+                    memory_order_release, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else {
+            // tail is lagging behind; help swing it forward
+            atomic_compare_exchange_weak_explicit(&pQueue->tail, &tail, makeLink(linkIndex(next), linkTag(tail) + 1),
+                memory_order_release, memory_order_relaxed);
+        }
+    }
+    // Swing tail to the new node; if this fails another thread already did it
+    atomic_compare_exchange_strong_explicit(&pQueue->tail, &tail, makeLink(nodeIndex, linkTag(tail) + 1),
+        memory_order_release, memory_order_relaxed);
+
+    atomic_fetch_add_explicit(&pQueue->count, 1, memory_order_relaxed);
+    return 0;
+}
+
+// Removes and returns the item at the front of pQueue.
+// Returns NULL if the queue is empty.
+void* ListQueue_dequeue(ListQueue* pQueue) {
+    assert(pQueue != NULL);
+
+    uint64_t head;
+    void* item;
+    for (;;) {
+        head = atomic_load_explicit(&pQueue->head, memory_order_acquire);
+        uint64_t tail = atomic_load_explicit(&pQueue->tail, memory_order_acquire);
+        QueueNode* headNode = queueNode(pQueue, linkIndex(head));
+        uint64_t next = atomic_load_explicit(&headNode->next, memory_order_acquire);
+        if (head != atomic_load_explicit(&pQueue->head, memory_order_acquire)) {
+            continue; // head moved while we read it
+        }
+        if (linkIndex(head) == linkIndex(tail)) {
+            if (linkIndex(next) == QUEUE_NIL) {
+                return NULL; // Empty
+            }
+            // tail is lagging behind; help swing it forward
+            atomic_compare_exchange_weak_explicit(&pQueue->tail, &tail, makeLink(linkIndex(next), linkTag(tail) + 1),
+                memory_order_release, memory_order_relaxed);
+        }
+        else {
+            // Read the item before the CAS: once head moves, another consumer may free the node
+            item = atomic_load_explicit(&queueNode(pQueue, linkIndex(next))->data, memory_order_relaxed);
+            if (atomic_compare_exchange_weak_explicit(&pQueue->head, &head, makeLink(linkIndex(next), linkTag(head) + 1),
+                    memory_order_acq_rel, memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+    // The old dummy is ours now; the node holding item becomes the new dummy
+    freeQueueNodeIndex((int)linkIndex(head));
+
+    atomic_fetch_sub_explicit(&pQueue->count, 1, memory_order_relaxed);
+    return item;
+}
+
+// Returns the number of items in pQueue.
+int ListQueue_count(ListQueue* pQueue) {
+    assert(pQueue != NULL);
+
+    // Dequeues can briefly run ahead of the enqueues they consumed
+    int count = atomic_load_explicit(&pQueue->count, memory_order_relaxed);
+    return count < 0 ? 0 : count;
+}
+
+// Delete pQueue, invoking pItemFreeFn on every item still queued.
+void ListQueue_free(ListQueue* pQueue, FREE_FN pItemFreeFn) {
+    assert(pQueue != NULL);
+
+    void* item;
+    while ((item = ListQueue_dequeue(pQueue)) != NULL) {
+        if (pItemFreeFn != NULL) {
+            pItemFreeFn(item);
+        }
+    }
+    freeQueueNodeIndex((int)linkIndex(atomic_load(&pQueue->head)));
+    free(pQueue);
+}
@@ -0,0 +1,34 @@
+// Lock-free multi-producer, multi-consumer FIFO queue.
+// Nodes come from a growable pool that all queues share, so a queue never fails
+// for lack of a fixed-size buffer.
+
+#ifndef _QUEUE_H_
+#define _QUEUE_H_
+#include "list.h"
+
+typedef struct ListQueue_s ListQueue;
+
+// Makes a new, empty queue, and returns its reference on success.
+// Returns a NULL pointer on failure.
+ListQueue* ListQueue_create();
+
+// Adds pItem to the back of pQueue. pItem must not be NULL.
+// Safe to call from any number of threads at once.
+// Returns 0 on success, -1 on failure.
+int ListQueue_enqueue(ListQueue* pQueue, void* pItem);
+
+// Removes and returns the item at the front of pQueue.
+// Returns NULL if the queue is empty.
+// Safe to call from any number of threads at once.
+void* ListQueue_dequeue(ListQueue* pQueue);
+
+// Returns the number of items in pQueue. While other threads are enqueuing or
+// dequeuing, this is only a snapshot and may be briefly off by the number of
+// operations in flight.
+int ListQueue_count(ListQueue* pQueue);
+
+// Delete pQueue, invoking pItemFreeFn on every item still queued (if pItemFreeFn is not NULL).
+// No other thread may be using pQueue.
+void ListQueue_free(ListQueue* pQueue, FREE_FN pItemFreeFn);
+
+#endif
@@ -1,8 +1,20 @@
 
 #include "list.h"
+#include "list_typed.h"
+#include "deque.h"
+#include "ilist.h"
+#include "lru.h"
+#include "pool.h"
+#include "queue.h"
+#include "ulist.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 // Helper function to free items
@@ -10,6 +22,11 @@ void freeItem(void* pItem) {
     free(pItem);
 }
 
+// Helper for lists whose items are not owned by the list
+void noopFree(void* pItem) {
+    (void)pItem;
+}
+
 // Helper function for comparison used in List_search
 bool compareInts(void* pItem, void* pComparisonArg) {
     return *(int*)pItem == *(int*)pComparisonArg;
@@ -76,6 +93,16 @@ void testListNextAndPrev() {
 
     assert(List_prev(myList) == data1);
 
+    // Walking off either end and back in with List_first/List_last starts a fresh walk
+    assert(List_next(myList) == data2);
+    assert(List_next(myList) == NULL);
+    assert(List_first(myList) == data1);
+    assert(List_next(myList) == data2);
+    assert(List_first(myList) == data1);
+    assert(List_prev(myList) == NULL);
+    assert(List_last(myList) == data2);
+    assert(List_prev(myList) == data1);
+
     printf("List_next and List_prev: Passed\n\n");
     List_free(myList, freeItem);
 }
@@ -140,6 +167,45 @@ void testListTrim() {
     List_free(myList, freeItem);
 }
 
+void testListMoveToFront() {
+    printf("Testing List_move_to_front...\n");
+    static int values[5] = { 0, 1, 2, 3, 4 };
+    List* myList = List_create();
+    assert(List_move_to_front(myList) == LIST_FAIL);
+    for (int i = 0; i < 5; i++) {
+        List_append(myList, &values[i]);
+    }
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+
+    List_seek(myList, 2);
+    assert(List_move_to_front(myList) == LIST_SUCCESS);
+    assert(List_curr(myList) == &values[2] && List_index_of_curr(myList) == 0);
+    List_last(myList);
+    assert(List_move_to_front(myList) == LIST_SUCCESS);
+    assert(List_last(myList) == &values[3]);
+    List_first(myList);
+    assert(List_move_to_front(myList) == LIST_SUCCESS);
+
+    // 4 2 0 1 3, linked both ways, with no node released or taken
+    int expected[] = { 4, 2, 0, 1, 3 };
+    int i = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        assert(*item == expected[i++]);
+    }
+    for (int* item = List_last(myList); item != NULL; item = List_prev(myList)) {
+        assert(*item == expected[--i]);
+    }
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse);
+
+    List_last(myList);
+    List_next(myList);
+    assert(List_move_to_front(myList) == LIST_FAIL);
+    List_free(myList, NULL);
+    printf("List_move_to_front: Passed\n\n");
+}
+
 void testListConcat() {
     printf("Testing List_concat...\n");
     List* list1 = List_create();
@@ -183,7 +249,2118 @@ void testListSearch() {
     List_free(myList, freeItem);
 }
 
+static int batchCalls;
+
+static int findIntInBatch(void** pItems, int count, void* pComparisonArg) {
+    assert(count >= 1 && count <= LIST_SEARCH_BATCH);
+    batchCalls++;
+    for (int i = 0; i < count; i++) {
+        if (*(int*)pItems[i] == *(int*)pComparisonArg) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Puts pList's cursor at position (-1 before the start, size beyond the end)
+static void placeCursor(List* pList, int position) {
+    if (position < 0) {
+        List_first(pList);
+        List_prev(pList);
+    }
+    else if (position >= List_count(pList)) {
+        List_last(pList);
+        List_next(pList);
+    }
+    else {
+        List_seek(pList, position);
+    }
+}
+
+void testListSearchBatch() {
+    printf("Testing List_search_batch...\n");
+    enum { NUM_ITEMS = 200 };
+    static int values[NUM_ITEMS];
+    List* myList = List_create();
+    batchCalls = 0;
+    int missing = -1;
+    assert(List_search_batch(myList, findIntInBatch, &missing) == NULL && batchCalls == 0);
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+        assert(List_append(myList, &values[i]) == LIST_SUCCESS);
+    }
+
+    // From every kind of start, the result, cursor and counters match List_search
+    int starts[] = { -1, 0, 10, 63, 64, 150, NUM_ITEMS - 1, NUM_ITEMS };
+    int keys[] = { 0, 10, 63, 64, 127, 128, 199, -1 };
+    for (int i = 0; i < (int)(sizeof(starts) / sizeof(starts[0])); i++) {
+        for (int j = 0; j < (int)(sizeof(keys) / sizeof(keys[0])); j++) {
+            ListOpCounts before, afterSearch, afterBatch;
+            placeCursor(myList, starts[i]);
+            List_get_op_counts(myList, &before);
+            void* expected = List_search(myList, compareInts, &keys[j]);
+            int expectedIndex = expected != NULL ? List_index_of_curr(myList) : -1;
+            List_get_op_counts(myList, &afterSearch);
+
+            placeCursor(myList, starts[i]);
+            void* found = List_search_batch(myList, findIntInBatch, &keys[j]);
+            List_get_op_counts(myList, &afterBatch);
+            assert(found == expected);
+            assert(found == NULL ? myList->curr == NULL && myList->oob_end && !myList->oob_start
+                : List_index_of_curr(myList) == expectedIndex && !myList->oob_end);
+            assert(afterBatch.searches - afterSearch.searches == 1);
+            assert(afterBatch.searchNodesVisited - afterSearch.searchNodesVisited
+                == afterSearch.searchNodesVisited - before.searchNodesVisited);
+        }
+    }
+
+    // One call per block of LIST_SEARCH_BATCH items
+    List_first(myList);
+    batchCalls = 0;
+    assert(List_search_batch(myList, findIntInBatch, &missing) == NULL);
+    assert(batchCalls == (NUM_ITEMS + LIST_SEARCH_BATCH - 1) / LIST_SEARCH_BATCH);
+    List_free(myList, NULL);
+    printf("List_search_batch: Passed\n\n");
+}
+
+typedef struct {
+    int key;
+    int seq; // Position before sorting, to check stability
+} SortItem;
+
+static int compareSortKeys(const void* pItem1, const void* pItem2) {
+    const SortItem* a = pItem1;
+    const SortItem* b = pItem2;
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static bool compareSortItems(void* pItem, void* pComparisonArg) {
+    return pItem == pComparisonArg;
+}
+
+static size_t hashSortItem(void* pItem) {
+    return (size_t)((SortItem*)pItem)->seq;
+}
+
+static bool sameSortSeq(void* pItem, void* pComparisonArg) {
+    return ((SortItem*)pItem)->seq == ((SortItem*)pComparisonArg)->seq;
+}
+
+void testListSort() {
+    printf("Testing List_sort...\n");
+    enum { NUM_ITEMS = 1000 };
+    static SortItem items[NUM_ITEMS];
+    List* myList = List_create();
+    assert(List_sort(myList, compareSortKeys) == LIST_SUCCESS && List_first(myList) == NULL);
+    items[0] = (SortItem){ 5, 0 };
+    List_append(myList, &items[0]);
+    assert(List_sort(myList, compareSortKeys) == LIST_SUCCESS && List_first(myList) == &items[0]);
+    List_free(myList, NULL);
+
+    // Every size up to a few runs, with many ties, against the expected order
+    srand(7);
+    for (int size = 2; size <= NUM_ITEMS; size = size < 70 ? size + 1 : size * 3) {
+        if (size > NUM_ITEMS) {
+            size = NUM_ITEMS;
+        }
+        myList = List_create();
+        assert(List_enable_index(myList, hashSortItem, sameSortSeq) == 0);
+        for (int i = 0; i < size; i++) {
+            items[i] = (SortItem){ rand() % 17, i };
+            assert(List_append(myList, &items[i]) == LIST_SUCCESS);
+        }
+        SortItem* current = &items[size / 3];
+        List_first(myList);
+        assert(List_search(myList, compareSortItems, current) == current);
+
+        assert(List_sort(myList, compareSortKeys) == LIST_SUCCESS);
+        assert(List_count(myList) == size);
+        assert(List_curr(myList) == current);
+        int position = List_index_of_curr(myList);
+        assert(List_seek(myList, position) == current);
+
+        // Ordered by key, ties in their old order, and the prev links agree
+        SortItem* previous = NULL;
+        int count = 0;
+        for (SortItem* item = List_first(myList); item != NULL; item = List_next(myList)) {
+            assert(previous == NULL || previous->key < item->key
+                || (previous->key == item->key && previous->seq < item->seq));
+            previous = item;
+            count++;
+        }
+        assert(count == size && List_last(myList) == previous);
+        for (SortItem* item = List_last(myList); item != NULL; item = List_prev(myList)) {
+            count--;
+        }
+        assert(count == 0);
+
+        // The hash index still finds every item
+        SortItem key = { 0, size - 1 };
+        assert(List_find_key(myList, &key) == &items[size - 1]);
+        List_free(myList, NULL);
+        if (size == NUM_ITEMS) {
+            break;
+        }
+    }
+
+    // Before the start and beyond the end stay where they are
+    myList = List_create();
+    for (int i = 0; i < 10; i++) {
+        items[i] = (SortItem){ 10 - i, i };
+        List_append(myList, &items[i]);
+    }
+    List_first(myList);
+    List_prev(myList);
+    assert(List_sort(myList, compareSortKeys) == LIST_SUCCESS);
+    assert(myList->curr == NULL && myList->oob_start && List_index_of_curr(myList) == -1);
+    assert(List_first(myList) == &items[9] && List_last(myList) == &items[0]);
+    List_next(myList);
+    assert(List_sort(myList, compareSortKeys) == LIST_SUCCESS);
+    assert(myList->curr == NULL && myList->oob_end && List_index_of_curr(myList) == -1);
+
+    // RCU readers could be walking the links a sort would rewrite
+    assert(List_enable_rcu(myList) == 0);
+    assert(List_sort(myList, compareSortKeys) == LIST_FAIL);
+    List_free(myList, NULL);
+    printf("List_sort: Passed\n\n");
+}
+
+void testListBulkInsert() {
+    printf("Testing List_append_n and List_insert_after_n...\n");
+    enum { BATCH = 1000 };
+    static int values[2 * BATCH];
+    void* items[2 * BATCH];
+    for (int i = 0; i < 2 * BATCH; i++) {
+        values[i] = i;
+        items[i] = &values[i];
+    }
+
+    // Appending to an empty list, then to a non-empty one
+    List* myList = List_create();
+    assert(List_append_n(myList, items, 0) == LIST_SUCCESS);
+    assert(List_count(myList) == 0);
+    assert(List_append_n(myList, items, 10) == LIST_SUCCESS);
+    assert(List_curr(myList) == items[9]);
+    assert(List_append_n(myList, &items[10], BATCH - 10) == LIST_SUCCESS);
+    assert(List_count(myList) == BATCH);
+    assert(List_curr(myList) == items[BATCH - 1]);
+
+    // Inserting a batch in the middle keeps both halves linked both ways
+    List_first(myList);
+    for (int i = 0; i < 9; i++) {
+        List_next(myList);
+    }
+    assert(List_insert_after_n(myList, &items[BATCH], BATCH) == LIST_SUCCESS);
+    assert(List_curr(myList) == items[2 * BATCH - 1]);
+    assert(List_next(myList) == items[10]);
+    assert(List_count(myList) == 2 * BATCH);
+    int expected[2 * BATCH];
+    int n = 0;
+    for (int i = 0; i < 10; i++) expected[n++] = i;
+    for (int i = BATCH; i < 2 * BATCH; i++) expected[n++] = i;
+    for (int i = 10; i < BATCH; i++) expected[n++] = i;
+    n = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        assert(*item == expected[n++]);
+    }
+    assert(n == 2 * BATCH);
+    for (int* item = List_last(myList); item != NULL; item = List_prev(myList)) {
+        assert(*item == expected[--n]);
+    }
+
+    // Beyond the end, a batch goes on the end
+    List_last(myList);
+    List_next(myList);
+    assert(List_insert_after_n(myList, items, 3) == LIST_SUCCESS);
+    assert(List_last(myList) == items[2]);
+    assert(List_count(myList) == 2 * BATCH + 3);
+    List_free(myList, noopFree);
+
+    // Into an empty list
+    myList = List_create();
+    assert(List_insert_after_n(myList, items, 5) == LIST_SUCCESS);
+    assert(List_first(myList) == items[0] && List_last(myList) == items[4]);
+    List_free(myList, noopFree);
+    printf("List_append_n and List_insert_after_n: Passed\n\n");
+}
+
+static int freedCount = 0;
+void countingFree(void* pItem) {
+    (void)pItem;
+    freedCount++;
+}
+
+void testListFreeWholeChain() {
+    printf("Testing List_free handing back whole chains...\n");
+    enum { NUM_ITEMS = 10000 };
+    static int values[NUM_ITEMS];
+
+    // With no free function, the items are left alone
+    List* myList = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+        List_append(myList, &values[i]);
+    }
+    List_free(myList, NULL);
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        assert(values[i] == i);
+    }
+
+    // With one, every item is visited once
+    myList = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        List_prepend(myList, &values[i]);
+    }
+    freedCount = 0;
+    List_free(myList, countingFree);
+    assert(freedCount == NUM_ITEMS);
+
+    // Nodes from the released chains are reused with clean links
+    List* list1 = List_create();
+    List* list2 = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        List_append(i % 2 ? list1 : list2, &values[i]);
+    }
+    assert(List_count(list1) == NUM_ITEMS / 2 && List_count(list2) == NUM_ITEMS / 2);
+    int expected = NUM_ITEMS - 2;
+    for (int* item = List_last(list2); item != NULL; item = List_prev(list2)) {
+        assert(*item == expected);
+        expected -= 2;
+    }
+    assert(expected == -2);
+    List_free(list1, NULL);
+    List_free(list2, NULL);
+    printf("List_free handing back whole chains: Passed\n\n");
+}
+
+// Finds the position of pItem by walking from the front; items in the test list are unique
+static int positionOf(List* pList, void* pItem) {
+    int position = 0;
+    for (void* item = List_first(pList); item != NULL; item = List_next(pList)) {
+        if (item == pItem) {
+            return position;
+        }
+        position++;
+    }
+    return -1;
+}
+
+void testListSeek() {
+    printf("Testing List_seek and List_index_of_curr...\n");
+    enum { NUM_VALUES = 4000, NUM_OPS = 4000 };
+    static int values[NUM_VALUES];
+    int nextValue = 0;
+    List* myList = List_create();
+    assert(List_seek(myList, 0) == NULL);
+    assert(List_index_of_curr(myList) == -1);
+
+    for (int i = 0; i < 100; i++) {
+        values[nextValue] = nextValue;
+        List_append(myList, &values[nextValue++]);
+    }
+    for (int i = 0; i < 100; i++) {
+        assert(*(int*)List_seek(myList, i) == i);
+        assert(List_index_of_curr(myList) == i);
+    }
+    assert(*(int*)List_seek(myList, 17) == 17);
+    assert(*(int*)List_seek(myList, 90) == 90);
+    assert(*(int*)List_seek(myList, 3) == 3);
+    assert(List_seek(myList, -1) == NULL && List_index_of_curr(myList) == -1);
+    assert(List_next(myList) == NULL);
+    assert(List_seek(myList, 100) == NULL && List_index_of_curr(myList) == -1);
+    assert(List_prev(myList) == NULL);
+
+    // The tracked position follows every kind of cursor movement and update
+    srand(777);
+    for (int op = 0; op < NUM_OPS; op++) {
+        void* item = NULL;
+        if (nextValue < NUM_VALUES) {
+            values[nextValue] = nextValue;
+            item = &values[nextValue];
+        }
+        int choice = rand() % 12;
+        if (item == NULL && choice >= 4 && choice <= 7) {
+            choice = 9;
+        }
+        switch (choice) {
+        case 0: List_first(myList); break;
+        case 1: List_last(myList); break;
+        case 2: List_next(myList); break;
+        case 3: List_prev(myList); break;
+        case 4: List_insert_after(myList, item); nextValue++; break;
+        case 5: List_insert_before(myList, item); nextValue++; break;
+        case 6: List_append(myList, item); nextValue++; break;
+        case 7: List_prepend(myList, item); nextValue++; break;
+        case 8: List_remove(myList); break;
+        case 9: List_trim(myList); break;
+        case 10: List_seek(myList, rand() % (List_count(myList) + 2) - 1); break;
+        default: {
+            int target = rand() % NUM_VALUES;
+            List_search(myList, compareInts, &target);
+            break;
+        }
+        }
+
+        int index = List_index_of_curr(myList);
+        if (index >= 0) {
+            void* current = List_curr(myList);
+            assert(positionOf(myList, current) == index);
+            assert(List_seek(myList, index) == current);
+        }
+    }
+    List_free(myList, NULL);
+    printf("List_seek and List_index_of_curr: Passed\n\n");
+}
+
+// Hash helper for List_enable_index; pairs with compareInts
+static size_t hashInt(void* pItem) {
+    return (size_t)*(int*)pItem;
+}
+
+void testListIndex() {
+    printf("Testing List_enable_index and List_find_key...\n");
+    enum { NUM_KEYS = 300, NUM_VALUES = 3000, NUM_OPS = 6000 };
+    static int values[NUM_VALUES];
+    int present[NUM_KEYS] = { 0 };
+    for (int i = 0; i < NUM_VALUES; i++) {
+        values[i] = i % NUM_KEYS; // Every key appears several times
+    }
+
+    // Items already in the list are indexed when the index is enabled
+    List* myList = List_create();
+    int nextValue = 0;
+    for (; nextValue < 50; nextValue++) {
+        List_append(myList, &values[nextValue]);
+        present[values[nextValue]]++;
+    }
+    assert(List_enable_index(myList, hashInt, compareInts) == 0);
+    int key = 7;
+    assert(List_find_key(myList, &key) == &values[7]);
+    assert(List_curr(myList) == &values[7] && List_index_of_curr(myList) == 7);
+    assert(List_next(myList) == &values[8]);
+    key = 99;
+    assert(List_find_key(myList, &key) == NULL);
+    assert(List_index_of_curr(myList) == -1);
+
+    // The index follows every update; a found item always matches its key and is
+    // positioned where List_index_of_curr says
+    srand(4242);
+    for (int op = 0; op < NUM_OPS; op++) {
+        void* item = nextValue < NUM_VALUES ? &values[nextValue] : NULL;
+        int choice = rand() % 10;
+        if (item == NULL && choice <= 4) {
+            choice = 6;
+        }
+        switch (choice) {
+        case 0: List_insert_after(myList, item); break;
+        case 1: List_insert_before(myList, item); break;
+        case 2: List_append(myList, item); break;
+        case 3: List_prepend(myList, item); break;
+        case 4: {
+            List* other = List_create();
+            List_append(other, item);
+            List_concat(myList, other);
+            break;
+        }
+        case 5: item = List_remove(myList); break;
+        case 6: item = List_trim(myList); break;
+        case 7: List_seek(myList, rand() % (List_count(myList) + 1)); item = NULL; break;
+        default: {
+            key = rand() % NUM_KEYS;
+            int* found = List_find_key(myList, &key);
+            assert((found != NULL) == (present[key] > 0));
+            if (found != NULL) {
+                assert(*found == key && List_curr(myList) == found);
+                assert(positionOf(myList, found) == List_index_of_curr(myList));
+            }
+            item = NULL;
+            break;
+        }
+        }
+        if (choice <= 4 && item != NULL) {
+            present[*(int*)item]++;
+            nextValue++;
+        }
+        else if ((choice == 5 || choice == 6) && item != NULL) {
+            present[*(int*)item]--;
+        }
+    }
+
+    // Bulk inserts are indexed too, and disabling the index leaves the list intact
+    static int extra[3] = { NUM_KEYS, NUM_KEYS + 1, NUM_KEYS + 2 };
+    void* extraItems[3] = { &extra[0], &extra[1], &extra[2] };
+    assert(List_append_n(myList, extraItems, 3) == 0);
+    key = NUM_KEYS + 1;
+    assert(List_find_key(myList, &key) == &extra[1]);
+    int count = List_count(myList);
+    List_disable_index(myList);
+    assert(List_count(myList) == count);
+    List_free(myList, NULL);
+    printf("List_enable_index and List_find_key: Passed\n\n");
+}
+
+void testListIter() {
+    printf("Testing ListIter...\n");
+    enum { NUM_ITEMS = 100 };
+    static int values[NUM_ITEMS];
+    List* myList = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+        assert(List_append(myList, &values[i]) == LIST_SUCCESS);
+    }
+    List_seek(myList, 40);
+    ListOpCounts before, after;
+    List_get_op_counts(myList, &before);
+
+    // Two iterators walk independently, in both directions
+    ListIter forward, backward;
+    ListIter_init(&forward, myList);
+    assert(ListIter_item(&forward) == NULL && ListIter_prev(&forward) == NULL);
+    assert(ListIter_end(&backward, myList) == &values[NUM_ITEMS - 1]);
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        assert(ListIter_next(&forward) == &values[i]);
+        assert(ListIter_item(&backward) == &values[NUM_ITEMS - 1 - i]);
+        ListIter_prev(&backward);
+    }
+    assert(ListIter_next(&forward) == NULL && ListIter_next(&forward) == NULL);
+    assert(ListIter_prev(&forward) == &values[NUM_ITEMS - 1]);
+    assert(ListIter_item(&backward) == NULL && ListIter_next(&backward) == &values[0]);
+
+    // Searches move only the iterator
+    int key = 70;
+    assert(ListIter_begin(&forward, myList) == &values[0]);
+    assert(ListIter_search(&forward, compareInts, &key) == &values[70]);
+    assert(ListIter_search(&forward, compareInts, &key) == &values[70]); // Starts at the match
+    key = 10;
+    assert(ListIter_search(&forward, compareInts, &key) == NULL && ListIter_item(&forward) == NULL);
+    assert(ListIter_prev(&forward) == &values[NUM_ITEMS - 1]);
+    ListIter_init(&forward, myList);
+    assert(ListIter_search(&forward, compareInts, &key) == &values[10]);
+
+    // The list's own cursor and counters are untouched
+    assert(List_curr(myList) == &values[40] && List_index_of_curr(myList) == 40);
+    List_get_op_counts(myList, &after);
+    assert(after.searches == before.searches && after.searchNodesVisited == before.searchNodesVisited);
+
+    // An iterator can start where the list's cursor is
+    ListIter_at_curr(&forward, myList);
+    assert(ListIter_item(&forward) == &values[40] && ListIter_next(&forward) == &values[41]);
+    List_last(myList);
+    List_next(myList);
+    ListIter_at_curr(&forward, myList);
+    assert(ListIter_item(&forward) == NULL && ListIter_next(&forward) == NULL);
+    assert(ListIter_prev(&forward) == &values[NUM_ITEMS - 1]);
+
+    // Changes between iterator calls are seen, as long as the iterator's item stays
+    ListIter_begin(&forward, myList);
+    List_first(myList);
+    List_insert_after(myList, &values[50]);
+    assert(ListIter_next(&forward) == &values[50]);
+
+    // Empty lists
+    List* empty = List_create();
+    assert(ListIter_begin(&forward, empty) == NULL && ListIter_next(&forward) == NULL);
+    assert(ListIter_end(&forward, empty) == NULL && ListIter_prev(&forward) == NULL);
+    List_free(empty, NULL);
+    List_free(myList, NULL);
+    printf("ListIter: Passed\n\n");
+}
+
+static bool compareLongs(void* pItem, void* pComparisonArg) {
+    return *(long*)pItem == *(long*)pComparisonArg;
+}
+
+// Each reader scans the shared list with its own iterator, without locking
+static void* iterReader(void* arg) {
+    List* pList = arg;
+    for (int round = 0; round < 50; round++) {
+        ListIter iter;
+        long expected = 0;
+        for (long* item = ListIter_begin(&iter, pList); item != NULL; item = ListIter_next(&iter)) {
+            assert(*item == expected++);
+        }
+        assert(expected == List_count(pList));
+        long key = round * 13 % expected;
+        ListIter_init(&iter, pList);
+        assert(*(long*)ListIter_search(&iter, compareLongs, &key) == key);
+    }
+    return NULL;
+}
+
+void testListIterThreads() {
+    printf("Testing concurrent readers with ListIter...\n");
+    enum { NUM_ITEMS = 5000, NUM_READERS = 4 };
+    static long values[NUM_ITEMS];
+    List* myList = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+        assert(List_append(myList, &values[i]) == LIST_SUCCESS);
+    }
+    pthread_t readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; i++) {
+        assert(pthread_create(&readers[i], NULL, iterReader, myList) == 0);
+    }
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    List_free(myList, NULL);
+    printf("Concurrent readers with ListIter: Passed\n\n");
+}
+
+typedef struct {
+    long value;
+    long check; // ~value while the item is live, 0 once it has been freed
+} RcuItem;
+
+static atomic_bool rcuWriterDone;
+
+// Walks the list under a read lock until the writer finishes. Values go up along the list,
+// and an item seen in a critical section must not be freed before the section ends.
+static void* rcuReader(void* arg) {
+    List* pList = arg;
+    while (!atomic_load(&rcuWriterDone)) {
+        List_rcu_read_lock();
+        ListIter iter;
+        long last = -1;
+        for (RcuItem* item = ListIter_begin(&iter, pList); item != NULL; item = ListIter_next(&iter)) {
+            assert(item->check == ~item->value && item->value > last);
+            last = item->value;
+        }
+        List_rcu_read_unlock();
+    }
+    return NULL;
+}
+
+static atomic_int rcuHolderState; // 1 once the holder is in its read section, 2 to let it leave
+static atomic_bool rcuReclaimed;
+
+// Sits in a read section on the first item until told to leave
+static void* rcuHolder(void* arg) {
+    List_rcu_read_lock();
+    ListIter iter;
+    RcuItem* item = ListIter_begin(&iter, arg);
+    atomic_store(&rcuHolderState, 1);
+    while (atomic_load(&rcuHolderState) != 2) {
+        sched_yield();
+    }
+    assert(item->check == ~item->value);
+    List_rcu_read_unlock();
+    return NULL;
+}
+
+static void* rcuReclaimer(void* arg) {
+    List_rcu_reclaim(arg);
+    atomic_store(&rcuReclaimed, true);
+    return NULL;
+}
+
+void testListRcu() {
+    printf("Testing RCU readers...\n");
+    enum { NUM_ITEMS = 500, NUM_REPLACEMENTS = 20000, NUM_READERS = 3 };
+    static RcuItem items[NUM_ITEMS + LIST_RCU_RETIRE_BATCH + 1];
+    RcuItem* spare[NUM_ITEMS + LIST_RCU_RETIRE_BATCH + 1];
+    RcuItem* removed[LIST_RCU_RETIRE_BATCH + 1];
+    int numSpare = 0;
+    int numRemoved = 0;
+    for (int i = NUM_ITEMS; i < (int)(sizeof(items) / sizeof(items[0])); i++) {
+        spare[numSpare++] = &items[i];
+    }
+
+    List* myList = List_create();
+    assert(List_enable_rcu(myList) == 0);
+    long nextValue = 0;
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        items[i] = (RcuItem){ nextValue, ~nextValue };
+        nextValue++;
+        assert(List_append(myList, &items[i]) == LIST_SUCCESS);
+    }
+
+    // A grace period waits for a reader that is still in its read section
+    pthread_t holder, reclaimer;
+    atomic_store(&rcuHolderState, 0);
+    atomic_store(&rcuReclaimed, false);
+    assert(pthread_create(&holder, NULL, rcuHolder, myList) == 0);
+    while (atomic_load(&rcuHolderState) != 1) {
+        sched_yield();
+    }
+    List_first(myList);
+    RcuItem* held = List_remove(myList);
+    assert(pthread_create(&reclaimer, NULL, rcuReclaimer, myList) == 0);
+    usleep(20000);
+    assert(!atomic_load(&rcuReclaimed));
+    atomic_store(&rcuHolderState, 2);
+    pthread_join(holder, NULL);
+    pthread_join(reclaimer, NULL);
+    assert(atomic_load(&rcuReclaimed) && myList->retired == NULL);
+    *held = (RcuItem){ nextValue, ~nextValue };
+    nextValue++;
+    assert(List_append(myList, held) == LIST_SUCCESS);
+
+    atomic_store(&rcuWriterDone, false);
+    pthread_t readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; i++) {
+        assert(pthread_create(&readers[i], NULL, rcuReader, myList) == 0);
+    }
+
+    // Replace the oldest item with a new one at the end. Removed items are freed (here,
+    // poisoned and reused) only after a grace period.
+    for (int i = 0; i < NUM_REPLACEMENTS; i++) {
+        List_first(myList);
+        removed[numRemoved++] = List_remove(myList);
+        if (numRemoved == LIST_RCU_RETIRE_BATCH || numSpare == 0) {
+            List_rcu_reclaim(myList);
+            assert(myList->retired == NULL && myList->numRetired == 0);
+            while (numRemoved > 0) {
+                RcuItem* item = removed[--numRemoved];
+                item->check = 0;
+                spare[numSpare++] = item;
+            }
+        }
+        RcuItem* item = spare[--numSpare];
+        *item = (RcuItem){ nextValue, ~nextValue };
+        nextValue++;
+        assert(List_append(myList, item) == LIST_SUCCESS);
+    }
+    atomic_store(&rcuWriterDone, true);
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    assert(List_count(myList) == NUM_ITEMS);
+    assert(((RcuItem*)List_first(myList))->value == NUM_REPLACEMENTS + 1);
+
+    // Read sections nest, and retired nodes go back to the pool in batches or on free
+    List_rcu_read_lock();
+    List_rcu_read_lock();
+    List_rcu_read_unlock();
+    List_rcu_read_unlock();
+    List_rcu_reclaim(myList);
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+    for (int i = 0; i < LIST_RCU_RETIRE_BATCH - 1; i++) {
+        List_trim(myList);
+    }
+    assert(myList->numRetired == LIST_RCU_RETIRE_BATCH - 1);
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse);
+    List_trim(myList);
+    assert(myList->numRetired == 0);
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse - LIST_RCU_RETIRE_BATCH);
+    List_first(myList);
+    List_remove(myList);
+    List_free(myList, NULL);
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse - NUM_ITEMS);
+    printf("RCU readers: Passed\n\n");
+}
+
+void testListArena() {
+    printf("Testing ListArena...\n");
+    enum { NUM_LISTS = 50, NUM_ITEMS = 200 };
+    static int values[NUM_ITEMS];
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+    }
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+
+    ListArena* arena = ListArena_create();
+    assert(arena != NULL);
+    List* lists[NUM_LISTS];
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < NUM_LISTS; i++) {
+            lists[i] = List_create_in(arena);
+            assert(lists[i] != NULL);
+            for (int j = 0; j < NUM_ITEMS; j++) {
+                assert(List_append(lists[i], &values[j]) == LIST_SUCCESS);
+            }
+        }
+        // Everything that works on a default list works in an arena
+        assert(List_enable_index(lists[0], hashInt, compareInts) == 0);
+        int key = 150;
+        assert(List_find_key(lists[0], &key) == &values[150]);
+        List_first(lists[1]);
+        assert(List_remove(lists[1]) == &values[0]);
+        assert(List_trim(lists[1]) == &values[NUM_ITEMS - 1]);
+        List_concat(lists[2], lists[3]);
+        assert(List_count(lists[2]) == 2 * NUM_ITEMS);
+        assert(List_seek(lists[2], NUM_ITEMS + 5) == &values[5]);
+        List_free(lists[4], NULL);
+
+        // Arena lists never touch the default arena's pools
+        List_get_pool_stats(&after);
+        assert(after.headsInUse == before.headsInUse);
+        assert(after.nodesInUse == before.nodesInUse);
+
+        // Reset drops every list at once, and the space is handed out again
+        List* first = lists[0];
+        ListArena_reset(arena);
+        List* reused = List_create_in(arena);
+        assert(reused == first);
+        assert(List_count(reused) == 0 && List_first(reused) == NULL);
+        ListArena_reset(arena);
+    }
+    ListArena_destroy(arena);
+
+    for (int i = 0; i < 100; i++) {
+        arena = ListArena_create();
+        List* pList = List_create_in(arena);
+        assert(pList != NULL && List_append(pList, &values[0]) == LIST_SUCCESS);
+        ListArena_destroy(arena);
+    }
+
+    // Destroyed pools give their slab numbers back, so creating arenas over and over
+    // does not use up a shared directory
+    PoolDirectory directory = POOL_DIRECTORY_INITIALIZER;
+    for (int i = 0; i < 100; i++) {
+        Pool pool;
+        Pool_initShared(&pool, sizeof(Node), &directory);
+        assert(Pool_alloc(&pool) >= 0);
+        Pool_destroy(&pool);
+    }
+    assert(directory.numSlabs == 1);
+    free(directory.slabs);
+    free(directory.freeNumbers);
+    printf("ListArena: Passed\n\n");
+}
+
+typedef struct Sample_s Sample;
+struct Sample_s {
+    int64_t id;
+    int64_t timestamp;
+};
+
+static size_t hashSampleId(void* pItem) {
+    return (size_t)((Sample*)pItem)->id;
+}
+
+static bool compareSampleIds(void* pItem, void* pComparisonArg) {
+    return ((Sample*)pItem)->id == ((Sample*)pComparisonArg)->id;
+}
+
+void testListInline() {
+    printf("Testing inline items...\n");
+    ListArena* arena = ListArena_create_inline(sizeof(Sample));
+#ifdef LIST_COMPACT_LINKS
+    assert(arena == NULL); // Inline arenas need pointer links
+    printf("Inline items: Skipped\n\n");
+    return;
+#endif
+    assert(arena != NULL);
+    List* myList = List_create_in(arena);
+    assert(myList != NULL);
+    assert(List_enable_index(myList, hashSampleId, compareSampleIds) == 0);
+
+    // Items are copied in, so the source can go out of scope
+    for (int i = 0; i < 100; i++) {
+        Sample sample = { i, 1000 + i };
+        assert(List_append_copy(myList, &sample) == LIST_SUCCESS);
+    }
+    Sample front = { -1, 999 };
+    assert(List_prepend_copy(myList, &front) == LIST_SUCCESS);
+    List_seek(myList, 50);
+    assert(List_insert_after_copy(myList, NULL) == LIST_SUCCESS);
+    Sample* filled = List_curr(myList);
+    assert(filled->id == 0 && filled->timestamp == 0);
+    filled->timestamp = 500; // Written in place through the returned pointer
+    assert(((Sample*)List_curr(myList))->timestamp == 500);
+    assert(List_insert_before_copy(myList, &front) == LIST_SUCCESS);
+    assert(List_count(myList) == 103);
+
+    Sample key = { 42, 0 };
+    assert(((Sample*)List_find_key(myList, &key))->timestamp == 1042);
+    List_first(myList);
+    Sample* found = List_search(myList, compareSampleIds, &key);
+    assert(found != NULL && found->timestamp == 1042);
+
+    Sample out;
+    List_first(myList);
+    assert(List_remove_copy(myList, &out) == 0 && out.id == -1);
+    assert(List_trim_copy(myList, &out) == 0 && out.id == 99 && out.timestamp == 1099);
+    assert(List_count(myList) == 101);
+
+    // Referenced items mix with inline ones, and only they reach the free function
+    static Sample referenced[3];
+    for (int i = 0; i < 3; i++) {
+        assert(List_append(myList, &referenced[i]) == LIST_SUCCESS);
+    }
+    freedCount = 0;
+    List_free(myList, countingFree);
+    assert(freedCount == 3);
+
+    // An empty list hands back nothing
+    myList = List_create_in(arena);
+    List_first(myList);
+    assert(List_remove_copy(myList, &out) == -1 && List_trim_copy(myList, &out) == -1);
+    List_free(myList, NULL);
+    ListArena_destroy(arena);
+    printf("Inline items: Passed\n\n");
+}
+
+typedef struct {
+    long id;
+    int qty;
+} Order;
+
+static inline bool sameOrderId(const Order* item, const Order* key) {
+    return item->id == key->id;
+}
+LIST_DEFINE(OrderList, Order, sameOrderId)
+
+#define LONGS_EQUAL(item, key) (*(item) == *(key))
+LIST_DEFINE(LongList, long, LONGS_EQUAL)
 
+static bool compareOrderIds(void* pItem, void* pComparisonArg) {
+    return ((Order*)pItem)->id == *(long*)pComparisonArg;
+}
+
+void testListTyped() {
+    printf("Testing typed lists...\n");
+    OrderList* orders = OrderList_create();
+#ifdef LIST_COMPACT_LINKS
+    assert(orders == NULL); // Typed lists store items inline
+    printf("Typed lists: Skipped\n\n");
+    return;
+#endif
+    assert(orders != NULL && OrderList_count(orders) == 0);
+    assert(OrderList_search(orders, (Order){ .id = 1 }) == NULL);
+    for (long i = 0; i < 100; i++) {
+        assert(OrderList_append(orders, (Order){ i, (int)i * 2 }) == LIST_SUCCESS);
+    }
+    List* list = OrderList_list(orders);
+
+    // Same results and cursor moves as List_search with a comparator
+    long keys[] = { 50, 50, 99, 3, -1, 0, 42 };
+    for (int i = 0; i < (int)(sizeof(keys) / sizeof(keys[0])); i++) {
+        int at = List_index_of_curr(list);
+        Order* expected = List_search(list, compareOrderIds, &keys[i]);
+        int expectedIndex = expected != NULL ? List_index_of_curr(list) : -1;
+        if (at >= 0) {
+            List_seek(list, at);
+        }
+        else {
+            List_first(list);
+            List_prev(list);
+        }
+        Order* found = OrderList_search(orders, (Order){ .id = keys[i] });
+        assert(found == expected);
+        assert(found == NULL ? list->curr == NULL && list->oob_end : List_index_of_curr(list) == expectedIndex);
+        if (found != NULL) {
+            assert(found->qty == keys[i] * 2);
+        }
+    }
+    // Searching starts at the current item, so an item behind it is not found
+    OrderList_first(orders);
+    OrderList_next(orders);
+    assert(OrderList_search(orders, (Order){ .id = 0 }) == NULL);
+    assert(OrderList_next(orders) == NULL);
+    ListOpCounts counts;
+    List_get_op_counts(list, &counts);
+    assert(counts.searches == 1 + 2 * 7 + 1);
+
+    Order out;
+    OrderList_first(orders);
+    assert(OrderList_remove(orders, &out) == 0 && out.id == 0);
+    assert(OrderList_trim(orders, &out) == 0 && out.id == 99);
+    assert(OrderList_curr(orders)->id == 1 && OrderList_last(orders)->id == 98);
+    OrderList* more = OrderList_create();
+    assert(OrderList_prepend(more, (Order){ 200, 1 }) == LIST_SUCCESS);
+    assert(OrderList_insert_before(more, (Order){ 199, 1 }) == LIST_SUCCESS);
+    assert(OrderList_insert_after(more, (Order){ 201, 1 }) == LIST_SUCCESS);
+    OrderList_concat(orders, more);
+    assert(OrderList_count(orders) == 101);
+    assert(OrderList_last(orders)->id == 200 && OrderList_prev(orders)->id == 201);
+    OrderList_free(orders);
+
+    // Types of the same size share an arena
+    LongList* longs = LongList_create();
+    assert(LongList_list(longs)->arena == ListArena_shared_inline(sizeof(long)));
+    for (long i = 0; i < 1000; i++) {
+        assert(LongList_append(longs, i * i) == LIST_SUCCESS);
+    }
+    LongList_first(longs);
+    assert(*LongList_search(longs, 961) == 961 && List_index_of_curr(LongList_list(longs)) == 31);
+    assert(LongList_search(longs, 962) == NULL);
+    LongList_free(longs);
+    printf("Typed lists: Passed\n\n");
+}
+
+// Records for referenced int items in a snapshot
+static void serializeInt(void* pItem, void* pRecord) {
+    *(int64_t*)pRecord = *(int*)pItem;
+}
+
+static void* deserializeInt(const void* pRecord) {
+    int* item = malloc(sizeof(int));
+    *item = (int)*(const int64_t*)pRecord;
+    return item;
+}
+
+void testListSnapshot() {
+    printf("Testing List_save and List_load...\n");
+    const char* path = "test_list_snapshot.tmp";
+    enum { NUM_ITEMS = 10000 };
+
+    // Referenced items go through a serializer and come back as new items
+    List* myList = List_create();
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        int* item = malloc(sizeof(int));
+        *item = i;
+        assert(List_append(myList, item) == LIST_SUCCESS);
+    }
+    List_seek(myList, 10);
+    assert(List_save(myList, path, sizeof(int64_t), serializeInt) == 0);
+    assert(*(int*)List_curr(myList) == 10); // Saving leaves the cursor alone
+    List_free(myList, freeItem);
+
+    List* loaded = List_load(path, deserializeInt);
+    assert(loaded != NULL && List_count(loaded) == NUM_ITEMS);
+    assert(*(int*)List_curr(loaded) == NUM_ITEMS - 1);
+    int expected = 0;
+    for (int* item = List_first(loaded); item != NULL; item = List_next(loaded)) {
+        assert(*item == expected++);
+    }
+    assert(expected == NUM_ITEMS);
+    assert(List_append(loaded, malloc(sizeof(int))) == LIST_SUCCESS); // An ordinary list from here on
+    assert(List_last(loaded) != NULL && *(int*)List_prev(loaded) == NUM_ITEMS - 1);
+    List_free(loaded, freeItem);
+
+    // Inline items are saved as raw bytes and copied straight into fresh nodes
+    ListArena* arena = ListArena_create_inline(sizeof(Sample));
+    if (arena != NULL) {
+        myList = List_create_in(arena);
+        for (int i = 0; i < NUM_ITEMS; i++) {
+            Sample sample = { i, -i };
+            assert(List_append_copy(myList, &sample) == LIST_SUCCESS);
+        }
+        assert(List_save(myList, path, sizeof(Sample), NULL) == 0);
+        List_free(myList, NULL);
+
+        ListArena* fresh = ListArena_create_inline(sizeof(Sample));
+        loaded = List_load_in(fresh, path, NULL);
+        assert(loaded != NULL && List_count(loaded) == NUM_ITEMS);
+        // Nodes are laid out in list order, breaking only where a slab ends
+        char* previous = List_first(loaded);
+        ptrdiff_t stride = (char*)List_next(loaded) - previous;
+        int breaks = 0;
+        int64_t id = 0;
+        for (Sample* sample = List_first(loaded); sample != NULL; sample = List_next(loaded)) {
+            assert(sample->id == id && sample->timestamp == -id);
+            if (id > 0 && (char*)sample - previous != stride) {
+                breaks++;
+            }
+            previous = (char*)sample;
+            id++;
+        }
+        assert(stride > 0 && breaks <= NUM_ITEMS / POOL_SLAB_SIZE + 1);
+        // The records must fit the arena's payload exactly
+        assert(List_load_in(arena, path, NULL) != NULL);
+        ListArena* other = ListArena_create_inline(sizeof(Sample) + 8);
+        assert(List_load_in(other, path, NULL) == NULL);
+        ListArena_destroy(other);
+        ListArena_destroy(fresh);
+        ListArena_destroy(arena);
+    }
+
+    // Missing and damaged files are refused
+    assert(List_load("test_list_no_such_file.tmp", deserializeInt) == NULL);
+    myList = List_create();
+    static int values[3] = { 1, 2, 3 };
+    for (int i = 0; i < 3; i++) {
+        assert(List_append(myList, &values[i]) == LIST_SUCCESS);
+    }
+    assert(List_save(myList, path, sizeof(int), NULL) == 0);
+    List_free(myList, NULL);
+    FILE* file = fopen(path, "r+b");
+    assert(file != NULL);
+    assert(fseek(file, -1, SEEK_END) == 0 && fputc('x', file) != EOF && fputc('x', file) != EOF);
+    fclose(file);
+    assert(List_load(path, deserializeInt) == NULL);
+    file = fopen(path, "wb");
+    assert(file != NULL && fputs("not a snapshot at all, just text", file) >= 0);
+    fclose(file);
+    assert(List_load(path, deserializeInt) == NULL);
+
+    // An empty list round-trips too
+    myList = List_create();
+    assert(List_save(myList, path, sizeof(int), NULL) == 0);
+    List_free(myList, NULL);
+    loaded = List_load(path, deserializeInt);
+    assert(loaded != NULL && List_count(loaded) == 0 && List_first(loaded) == NULL);
+    List_free(loaded, NULL);
+    remove(path);
+    printf("List_save and List_load: Passed\n\n");
+}
+
+// Fills a persistent arena with two lists and exits without closing it, as a crash would.
+// With corrupt set, one list's links are broken first.
+static void crashAfterFillingArena(const char* path, bool corrupt) {
+    ListArena* arena = ListArena_open(path, sizeof(Sample), 20000, 10);
+    assert(arena != NULL);
+    List* samples = List_create_in(arena);
+    List* empty = List_create_in(arena);
+    for (int i = 0; i < 10000; i++) {
+        Sample sample = { i, 2 * i };
+        assert(List_append_copy(samples, &sample) == LIST_SUCCESS);
+    }
+    ListArena_set_root(arena, 0, samples);
+    ListArena_set_root(arena, 3, empty);
+    if (corrupt) {
+        samples->head->prev = samples->head->next;
+    }
+    _exit(0);
+}
+
+void testListPersistentArena() {
+    printf("Testing persistent arenas...\n");
+    const char* path = "test_list_arena.tmp";
+    remove(path);
+#ifdef LIST_COMPACT_LINKS
+    assert(ListArena_open(path, sizeof(Sample), 100, 10) == NULL);
+    remove(path);
+    printf("Persistent arenas: Skipped\n\n");
+    return;
+#endif
+
+    // Lists made by another process that died come back intact
+    pid_t child = fork();
+    if (child == 0) {
+        crashAfterFillingArena(path, false);
+    }
+    int status;
+    assert(waitpid(child, &status, 0) == child && WIFEXITED(status));
+    ListArena* arena = ListArena_open(path, sizeof(Sample), 1, 1);
+    assert(arena != NULL);
+    List* samples = ListArena_get_root(arena, 0);
+    assert(samples != NULL && List_count(samples) == 10000);
+    int64_t id = 0;
+    for (Sample* sample = List_first(samples); sample != NULL; sample = List_next(samples)) {
+        assert(sample->id == id && sample->timestamp == 2 * id);
+        id++;
+    }
+    assert(List_count(ListArena_get_root(arena, 3)) == 0 && ListArena_get_root(arena, 1) == NULL);
+    assert(List_enable_index(samples, hashSampleId, compareSampleIds) == -1);
+
+    // They work as usual, and changes last across a clean close
+    Sample out;
+    List_first(samples);
+    assert(List_remove_copy(samples, &out) == 0 && out.id == 0);
+    Sample extra = { -5, -5 };
+    assert(List_prepend_copy(samples, &extra) == LIST_SUCCESS);
+    List_concat(samples, ListArena_get_root(arena, 3));
+    ListArena_set_root(arena, 3, NULL);
+    assert(ListArena_sync(arena) == 0);
+    ListArena_close(arena);
+
+    // The capacity is fixed when the file is made, and the payload size has to match
+    assert(ListArena_open(path, sizeof(Sample) + 8, 1, 1) == NULL);
+    arena = ListArena_open(path, sizeof(Sample), 1, 1);
+    assert(arena != NULL);
+    samples = ListArena_get_root(arena, 0);
+    assert(List_count(samples) == 10000 && ((Sample*)List_first(samples))->id == -5);
+    assert(((Sample*)List_next(samples))->id == 1);
+    List* filler = List_create_in(arena);
+    int added = 0;
+    while (List_append_copy(filler, &extra) == LIST_SUCCESS) {
+        added++;
+    }
+    assert(added >= 20000 - 10000 && added < 20000);
+    ListArena_close(arena);
+
+    // After a crash, a root list with broken links makes the open fail
+    remove(path);
+    child = fork();
+    if (child == 0) {
+        crashAfterFillingArena(path, true);
+    }
+    assert(waitpid(child, &status, 0) == child && WIFEXITED(status));
+    assert(ListArena_open(path, sizeof(Sample), 1, 1) == NULL);
+
+    // So does a file that is not an arena
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL && fputs("not an arena", file) >= 0);
+    fclose(file);
+    assert(ListArena_open(path, sizeof(Sample), 1, 1) == NULL);
+    remove(path);
+    printf("Persistent arenas: Passed\n\n");
+}
+
+void testListPoolGrowth() {
+    printf("Testing pool growth past the historical limits...\n");
+    enum { NUM_LISTS = 4 * LIST_MAX_NUM_HEADS, NUM_ITEMS = 50 * LIST_MAX_NUM_NODES };
+    List* lists[NUM_LISTS];
+    for (int i = 0; i < NUM_LISTS; i++) {
+        lists[i] = List_create();
+        assert(lists[i] != NULL);
+    }
+
+    // Spread enough items over the lists to need several slabs
+    static int values[NUM_ITEMS];
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        values[i] = i;
+        assert(List_append(lists[i % NUM_LISTS], &values[i]) == LIST_SUCCESS);
+    }
+    void* firstItem = List_first(lists[0]);
+
+    // Earlier nodes are untouched by growth
+    for (int i = 0; i < NUM_LISTS; i++) {
+        assert(List_count(lists[i]) == NUM_ITEMS / NUM_LISTS);
+        int expected = i;
+        for (int* item = List_first(lists[i]); item != NULL; item = List_next(lists[i])) {
+            assert(*item == expected);
+            expected += NUM_LISTS;
+        }
+    }
+    assert(List_first(lists[0]) == firstItem);
+
+    // Concatenating frees a head, which List_create can hand out again
+    List_concat(lists[0], lists[1]);
+    assert(List_count(lists[0]) == 2 * NUM_ITEMS / NUM_LISTS);
+    lists[1] = List_create();
+    assert(lists[1] != NULL && List_count(lists[1]) == 0);
+
+    for (int i = 0; i < NUM_LISTS; i++) {
+        while (List_trim(lists[i]) != NULL) {
+        }
+        List_free(lists[i], freeItem);
+    }
+    printf("Pool growth: Passed\n\n");
+}
+
+// Each worker churns its own list; node indices move between threads through the shared depot
+static void* listWorker(void* arg) {
+    int id = (int)(long)arg;
+    List* myList = List_create();
+    assert(myList != NULL);
+    for (int round = 0; round < 200; round++) {
+        for (long i = 0; i < 500; i++) {
+            assert(List_append(myList, (void*)(i + 1)) == LIST_SUCCESS);
+        }
+        long expected = 1;
+        for (void* item = List_first(myList); item != NULL; item = List_next(myList)) {
+            assert((long)item == expected++);
+        }
+        // Trim some rounds and free the rest so frees hit both the magazine and the depot
+        if ((round + id) % 2 == 0) {
+            while (List_trim(myList) != NULL) {
+            }
+        }
+        else {
+            List_free(myList, noopFree);
+            myList = List_create();
+            assert(myList != NULL);
+        }
+    }
+    List_free(myList, noopFree);
+    return NULL;
+}
+
+void testListThreads() {
+    printf("Testing lists on several threads...\n");
+    enum { NUM_THREADS = 4 };
+    pthread_t threads[NUM_THREADS];
+    for (long i = 0; i < NUM_THREADS; i++) {
+        assert(pthread_create(&threads[i], NULL, listWorker, (void*)i) == 0);
+    }
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    printf("Lists on several threads: Passed\n\n");
+}
+
+// Searches a list from another thread, which then exits
+static void* statsWorker(void* arg) {
+    List* pList = arg;
+    int target = -1;
+    List_first(pList);
+    List_search(pList, compareInts, &target);
+    return NULL;
+}
+
+void testListStats() {
+    printf("Testing List_get_op_counts and List_get_pool_stats...\n");
+    static int values[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+
+    List* myList = List_create();
+    for (int i = 0; i < 10; i++) {
+        List_append(myList, &values[i]);
+    }
+    int target = 3;
+    List_first(myList);
+    assert(List_search(myList, compareInts, &target) == &values[3]); // 4 nodes compared
+    target = -1;
+    assert(List_search(myList, compareInts, &target) == NULL);       // 7 more
+    List_first(myList);
+    List_remove(myList);
+    List_trim(myList);
+
+    ListOpCounts counts;
+    List_get_op_counts(myList, &counts);
+    assert(counts.inserts == 10 && counts.removes == 2);
+    assert(counts.searches == 2 && counts.searchNodesVisited == 11);
+    assert(counts.keyLookups == 0);
+
+    List_get_pool_stats(&after);
+    assert(after.headsInUse == before.headsInUse + 1);
+    assert(after.headsHighWater >= after.headsInUse && after.headCapacity >= after.headsInUse);
+    assert(after.nodesInUse == before.nodesInUse + 8);
+    assert(after.nodesReserved >= after.nodesInUse && after.nodesHighWater >= after.nodesReserved);
+    assert(after.nodeCapacity >= after.nodesHighWater);
+    assert(after.searches == before.searches + 2);
+    assert(after.searchLengths[3] == before.searchLengths[3] + 2); // 4 and 7 fall in [4, 8)
+    assert(after.nodeAllocFailures == before.nodeAllocFailures);
+    assert(after.headAllocFailures == before.headAllocFailures);
+
+    // Counts from a thread that has exited are kept
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, statsWorker, myList) == 0);
+    pthread_join(thread, NULL);
+    List_get_pool_stats(&after);
+    assert(after.searches == before.searches + 3);
+    assert(after.searchLengths[4] == before.searchLengths[4] + 1); // 8 nodes
+
+    List_free(myList, NULL);
+    List_get_pool_stats(&after);
+    assert(after.headsInUse == before.headsInUse);
+    assert(after.nodesInUse == before.nodesInUse);
+    printf("List_get_op_counts and List_get_pool_stats: Passed\n\n");
+}
+
+typedef struct {
+    int key;
+    int value;
+} CacheEntry;
+
+static size_t hashCacheKey(void* pItem) {
+    return (size_t)((CacheEntry*)pItem)->key;
+}
+
+static bool sameCacheKey(void* pItem, void* pComparisonArg) {
+    return ((CacheEntry*)pItem)->key == ((CacheEntry*)pComparisonArg)->key;
+}
+
+static void recordEviction(void* pItem, void* pArg) {
+    CacheEntry** pLast = pArg;
+    *pLast = pItem;
+}
+
+// Checks that pLru holds the entries with the given keys, most recently used first
+// EVICT_FN that owns its items
+static void freeEvicted(void* pItem, void* pArg) {
+    (void)pArg;
+    free(pItem);
+}
+
+static void checkLruOrder(ListLru* pLru, const int* keys, int count) {
+    assert(ListLru_count(pLru) == count);
+    ListIter iter;
+    int i = 0;
+    for (CacheEntry* entry = ListIter_begin(&iter, ListLru_list(pLru)); entry != NULL; entry = ListIter_next(&iter)) {
+        assert(i < count && entry->key == keys[i++]);
+    }
+    assert(i == count);
+}
+
+void testListLru() {
+    printf("Testing ListLru...\n");
+    static CacheEntry entries[10];
+    for (int i = 0; i < 10; i++) {
+        entries[i] = (CacheEntry){ i, i * 10 };
+    }
+    CacheEntry* lastEvicted = NULL;
+    ListLru* pLru = ListLru_create(3, hashCacheKey, sameCacheKey, recordEviction, &lastEvicted);
+    assert(pLru != NULL);
+    CacheEntry key = { 1, 0 };
+    assert(ListLru_get(pLru, &key) == NULL && ListLru_evict(pLru) == -1);
+
+    for (int i = 1; i <= 3; i++) {
+        assert(ListLru_put(pLru, &entries[i]) == 0);
+    }
+    checkLruOrder(pLru, (int[]){ 3, 2, 1 }, 3);
+    assert(ListLru_get(pLru, &key) == &entries[1]);
+    checkLruOrder(pLru, (int[]){ 1, 3, 2 }, 3);
+
+    // A put into a full cache evicts the least recently used
+    assert(ListLru_put(pLru, &entries[4]) == 0 && lastEvicted == &entries[2]);
+    checkLruOrder(pLru, (int[]){ 4, 1, 3 }, 3);
+
+    // peek leaves the order alone; touch does not
+    key.key = 3;
+    assert(ListLru_peek(pLru, &key) == &entries[3]);
+    checkLruOrder(pLru, (int[]){ 4, 1, 3 }, 3);
+    assert(ListLru_touch(pLru, &key) == 0);
+    checkLruOrder(pLru, (int[]){ 3, 4, 1 }, 3);
+    key.key = 2;
+    assert(ListLru_touch(pLru, &key) == -1 && ListLru_peek(pLru, &key) == NULL);
+
+    // Putting a key that is there replaces its item, which goes to the callback
+    CacheEntry newer = { 1, 99 };
+    lastEvicted = NULL;
+    assert(ListLru_put(pLru, &newer) == 0 && lastEvicted == &entries[1]);
+    checkLruOrder(pLru, (int[]){ 1, 3, 4 }, 3);
+    key.key = 1;
+    assert(ListLru_get(pLru, &key) == &newer);
+
+    key.key = 3;
+    lastEvicted = NULL;
+    assert(ListLru_remove(pLru, &key) == &entries[3] && lastEvicted == NULL);
+    checkLruOrder(pLru, (int[]){ 1, 4 }, 2);
+    assert(ListLru_evict(pLru) == 0 && lastEvicted == &entries[4]);
+    checkLruOrder(pLru, (int[]){ 1 }, 1);
+    ListLru_free(pLru, NULL);
+
+    // Putting an item that is already cached must not evict (here, free) it
+    pLru = ListLru_create(2, hashCacheKey, sameCacheKey, freeEvicted, NULL);
+    CacheEntry* owned = malloc(sizeof(CacheEntry));
+    *owned = (CacheEntry){ 5, 50 };
+    CacheEntry* other = malloc(sizeof(CacheEntry));
+    *other = (CacheEntry){ 6, 60 };
+    assert(ListLru_put(pLru, owned) == 0 && ListLru_put(pLru, other) == 0);
+    assert(ListLru_put(pLru, owned) == 0);
+    assert(ListLru_count(pLru) == 2);
+    key.key = 5;
+    assert(ListLru_peek(pLru, &key) == owned && owned->value == 50);
+    assert(ListLru_evict(pLru) == 0); // other was least recently used, and is freed
+    assert(ListLru_get(pLru, &key) == owned);
+    ListLru_free(pLru, free);
+
+    // Against a plain array kept in recency order, over many random operations
+    enum { CAPACITY = 50, KEYS = 120, OPS = 20000 };
+    static CacheEntry pool[KEYS];
+    int model[CAPACITY + 1];
+    int modelCount = 0;
+    pLru = ListLru_create(CAPACITY, hashCacheKey, sameCacheKey, recordEviction, &lastEvicted);
+    srand(11);
+    for (int op = 0; op < OPS; op++) {
+        int k = rand() % KEYS;
+        int at = -1;
+        for (int i = 0; i < modelCount; i++) {
+            if (model[i] == k) {
+                at = i;
+            }
+        }
+        key.key = k;
+        if (rand() % 2 == 0) {
+            CacheEntry* found = ListLru_get(pLru, &key);
+            assert((found != NULL) == (at >= 0));
+            if (at < 0) {
+                continue;
+            }
+            assert(found == &pool[k]);
+        }
+        else {
+            pool[k] = (CacheEntry){ k, op };
+            lastEvicted = NULL;
+            assert(ListLru_put(pLru, &pool[k]) == 0);
+            if (at < 0) {
+                at = modelCount++;
+                if (modelCount > CAPACITY) {
+                    assert(lastEvicted == &pool[model[CAPACITY - 1]]);
+                    modelCount--;
+                    at = CAPACITY - 1;
+                }
+            }
+        }
+        // Move key k to the front of the model
+        for (int i = at; i > 0; i--) {
+            model[i] = model[i - 1];
+        }
+        model[0] = k;
+    }
+    checkLruOrder(pLru, model, modelCount);
+    ListLru_free(pLru, NULL);
+    printf("ListLru: Passed\n\n");
+}
+
+void testListQueue() {
+    printf("Testing ListQueue on one thread...\n");
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+    ListQueue* queue = ListQueue_create();
+    assert(queue != NULL);
+    assert(ListQueue_dequeue(queue) == NULL);
+    assert(ListQueue_count(queue) == 0);
+
+    for (long i = 1; i <= 1000; i++) {
+        assert(ListQueue_enqueue(queue, (void*)i) == LIST_SUCCESS);
+    }
+    assert(ListQueue_count(queue) == 1000);
+    // Queue nodes never come from the list node pool, whose users overwrite their tags
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse && after.nodesReserved == before.nodesReserved);
+    for (long i = 1; i <= 500; i++) {
+        assert(ListQueue_dequeue(queue) == (void*)i);
+    }
+    assert(ListQueue_count(queue) == 500);
+
+    int* data = malloc(sizeof(int));
+    ListQueue_enqueue(queue, data);
+    while (ListQueue_count(queue) > 1) {
+        ListQueue_dequeue(queue);
+    }
+    ListQueue_free(queue, freeItem);
+    printf("ListQueue on one thread: Passed\n\n");
+}
+
+enum { QUEUE_PRODUCERS = 3, QUEUE_CONSUMERS = 3, QUEUE_ITEMS_PER_PRODUCER = 20000 };
+static ListQueue* sharedQueue;
+static long consumedSums[QUEUE_CONSUMERS];
+
+// Items encode (producer, sequence), so each consumer can check per-producer FIFO order
+static void* queueProducer(void* arg) {
+    long producer = (long)arg;
+    for (long seq = 1; seq <= QUEUE_ITEMS_PER_PRODUCER; seq++) {
+        assert(ListQueue_enqueue(sharedQueue, (void*)(producer << 32 | seq)) == LIST_SUCCESS);
+    }
+    return NULL;
+}
+
+static void* queueConsumer(void* arg) {
+    long consumer = (long)arg;
+    long lastSeq[QUEUE_PRODUCERS] = {0};
+    long target = (long)QUEUE_PRODUCERS * QUEUE_ITEMS_PER_PRODUCER / QUEUE_CONSUMERS;
+    for (long taken = 0; taken < target; ) {
+        long item = (long)ListQueue_dequeue(sharedQueue);
+        if (item == 0) {
+            continue;
+        }
+        long producer = item >> 32;
+        long seq = item & 0xffffffff;
+        assert(seq > lastSeq[producer]);
+        lastSeq[producer] = seq;
+        consumedSums[consumer] += seq;
+        taken++;
+    }
+    return NULL;
+}
+
+void testListQueueThreads() {
+    printf("Testing ListQueue across threads...\n");
+    sharedQueue = ListQueue_create();
+    assert(sharedQueue != NULL);
+
+    pthread_t producers[QUEUE_PRODUCERS];
+    pthread_t consumers[QUEUE_CONSUMERS];
+    for (long i = 0; i < QUEUE_CONSUMERS; i++) {
+        assert(pthread_create(&consumers[i], NULL, queueConsumer, (void*)i) == 0);
+    }
+    for (long i = 0; i < QUEUE_PRODUCERS; i++) {
+        assert(pthread_create(&producers[i], NULL, queueProducer, (void*)i) == 0);
+    }
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (int i = 0; i < QUEUE_CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    // Every item was taken exactly once
+    long total = 0;
+    for (int i = 0; i < QUEUE_CONSUMERS; i++) {
+        total += consumedSums[i];
+    }
+    long perProducer = (long)QUEUE_ITEMS_PER_PRODUCER * (QUEUE_ITEMS_PER_PRODUCER + 1) / 2;
+    assert(total == QUEUE_PRODUCERS * perProducer);
+    assert(ListQueue_count(sharedQueue) == 0);
+    assert(ListQueue_dequeue(sharedQueue) == NULL);
+
+    ListQueue_free(sharedQueue, NULL);
+    printf("ListQueue across threads: Passed\n\n");
+}
+
+// Runs the same random operations on a List and a UList and checks that every
+// result, and so the cursor position, matches
+void testUListMatchesList() {
+    printf("Testing UList against List...\n");
+    enum { NUM_VALUES = 64, NUM_OPS = 200000 };
+    static int values[NUM_VALUES];
+    for (int i = 0; i < NUM_VALUES; i++) {
+        values[i] = i;
+    }
+    List* list = List_create();
+    UList* ulist = UList_create();
+    srand(12345);
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        int* value = &values[rand() % NUM_VALUES];
+        // Bias towards inserts while small and removes while large so chunks split and merge
+        int choice = rand() % 14;
+        if (List_count(list) > 300 && choice >= 4 && choice <= 7) {
+            choice = 8 + choice % 2;
+        }
+        switch (choice) {
+        case 0: assert(List_first(list) == UList_first(ulist)); break;
+        case 1: assert(List_last(list) == UList_last(ulist)); break;
+        case 2: assert(List_next(list) == UList_next(ulist)); break;
+        case 3: assert(List_prev(list) == UList_prev(ulist)); break;
+        case 4: assert(List_insert_after(list, value) == UList_insert_after(ulist, value)); break;
+        case 5: assert(List_insert_before(list, value) == UList_insert_before(ulist, value)); break;
+        case 6: assert(List_append(list, value) == UList_append(ulist, value)); break;
+        case 7: assert(List_prepend(list, value) == UList_prepend(ulist, value)); break;
+        case 8: assert(List_remove(list) == UList_remove(ulist)); break;
+        case 9: assert(List_trim(list) == UList_trim(ulist)); break;
+        case 10: assert(List_search(list, compareInts, value) == UList_search(ulist, compareInts, value)); break;
+        case 11: {
+            // Concatenate a short run of items onto both
+            List* list2 = List_create();
+            UList* ulist2 = UList_create();
+            for (int i = rand() % 20; i > 0; i--) {
+                List_append(list2, value);
+                UList_append(ulist2, value);
+            }
+            List_concat(list, list2);
+            UList_concat(ulist, ulist2);
+            break;
+        }
+        default:
+            if (List_count(list) > 0 && list->curr != NULL) {
+                assert(List_curr(list) == UList_curr(ulist));
+            }
+            break;
+        }
+        assert(List_count(list) == UList_count(ulist));
+    }
+
+    // Same contents in the same order
+    void* item = List_first(list);
+    void* uitem = UList_first(ulist);
+    while (item != NULL || uitem != NULL) {
+        assert(item == uitem);
+        item = List_next(list);
+        uitem = UList_next(ulist);
+    }
+
+    List_free(list, noopFree);
+    UList_free(ulist, noopFree);
+    printf("UList against List: Passed\n\n");
+}
+
+// Runs one random List operation on list and the same on deque, and checks they agree.
+// Middle inserts are left out unless allowInserts is set.
+static void stepListAndDeque(List* list, ListDeque* deque, int* values, int numValues, bool allowInserts) {
+    int* value = &values[rand() % numValues];
+    // Bias towards adding while small and taking away while large
+    int choice = rand() % 15;
+    if (List_count(list) > 300 && ((choice >= 4 && choice <= 7) || choice == 13)) {
+        choice = 8 + choice % 2;
+    }
+    switch (choice) {
+    case 0: assert(List_first(list) == ListDeque_first(deque)); break;
+    case 1: assert(List_last(list) == ListDeque_last(deque)); break;
+    case 2: assert(List_next(list) == ListDeque_next(deque)); break;
+    case 3: assert(List_prev(list) == ListDeque_prev(deque)); break;
+    case 4:
+        if (!allowInserts) {
+            assert(List_last(list) == ListDeque_last(deque));
+        }
+        assert(List_insert_after(list, value) == ListDeque_insert_after(deque, value));
+        break;
+    case 5:
+        if (!allowInserts) {
+            assert(List_first(list) == ListDeque_first(deque));
+        }
+        assert(List_insert_before(list, value) == ListDeque_insert_before(deque, value));
+        break;
+    case 6: assert(List_append(list, value) == ListDeque_append(deque, value)); break;
+    case 7: assert(List_prepend(list, value) == ListDeque_prepend(deque, value)); break;
+    case 8: assert(List_remove(list) == ListDeque_remove(deque)); break;
+    case 9: assert(List_trim(list) == ListDeque_trim(deque)); break;
+    case 10: assert(List_search(list, compareInts, value) == ListDeque_search(deque, compareInts, value)); break;
+    case 11: {
+        // Concatenate a short run of items onto both
+        List* list2 = List_create();
+        ListDeque* deque2 = ListDeque_create();
+        for (int i = rand() % 20; i > 0; i--) {
+            List_append(list2, value);
+            ListDeque_append(deque2, value);
+        }
+        List_concat(list, list2);
+        assert(ListDeque_concat(deque, deque2) == 0);
+        break;
+    }
+    case 12:
+        if (List_count(list) > 0 && list->curr != NULL) {
+            assert(List_curr(list) == ListDeque_curr(deque));
+        }
+        break;
+    default:
+        // A burst of prepends and trims, so the items wrap round the end of the array
+        for (int i = 0; i < 5; i++) {
+            assert(List_prepend(list, value) == ListDeque_prepend(deque, value));
+        }
+        assert(List_trim(list) == ListDeque_trim(deque));
+        break;
+    }
+    assert(List_count(list) == ListDeque_count(deque));
+}
+
+// Checks list and deque hold the same items in the same order
+static void assertSameItems(List* list, ListDeque* deque) {
+    void* item = List_first(list);
+    void* ditem = ListDeque_first(deque);
+    while (item != NULL || ditem != NULL) {
+        assert(item == ditem);
+        item = List_next(list);
+        ditem = ListDeque_next(deque);
+    }
+}
+
+void testListDequeMatchesList() {
+    printf("Testing ListDeque against List...\n");
+    enum { NUM_VALUES = 64, NUM_OPS = 200000 };
+    static int values[NUM_VALUES];
+    for (int i = 0; i < NUM_VALUES; i++) {
+        values[i] = i;
+    }
+    List* list = List_create();
+    ListDeque* deque = ListDeque_create();
+    srand(2468);
+
+    // Inserts only at the ends, and removes anywhere, keep the deque in its array
+    for (int op = 0; op < NUM_OPS; op++) {
+        stepListAndDeque(list, deque, values, NUM_VALUES, false);
+    }
+    assert(deque->list == NULL);
+    assertSameItems(list, deque);
+
+    // The first middle insert moves it to linked nodes, with the cursor where it was
+    List_first(list);
+    ListDeque_first(deque);
+    while (List_count(list) < 3) {
+        List_append(list, &values[0]);
+        ListDeque_append(deque, &values[0]);
+    }
+    List_first(list);
+    ListDeque_first(deque);
+    assert(List_next(list) == ListDeque_next(deque));
+    assert(List_insert_after(list, &values[1]) == ListDeque_insert_after(deque, &values[1]));
+    assert(deque->list != NULL);
+    for (int op = 0; op < NUM_OPS / 4; op++) {
+        stepListAndDeque(list, deque, values, NUM_VALUES, true);
+    }
+    assertSameItems(list, deque);
+
+    // An array deque concatenated with a linked one takes on linked nodes
+    ListDeque* front = ListDeque_create();
+    ListDeque_append(front, &values[2]);
+    List* frontList = List_create();
+    List_append(frontList, &values[2]);
+    assert(ListDeque_concat(front, deque) == 0);
+    List_concat(frontList, list);
+    assert(front->list != NULL);
+    assertSameItems(frontList, front);
+
+    List_free(frontList, noopFree);
+    ListDeque_free(front, noopFree);
+    printf("ListDeque against List: Passed\n\n");
+}
+
+typedef struct TestRecord_s TestRecord;
+struct TestRecord_s {
+    int value;
+    IListLink link;
+};
+
+static bool compareRecordLinks(void* pItem, void* pComparisonArg) {
+    return ILIST_ENTRY((IListLink*)pItem, TestRecord, link)->value == *(int*)pComparisonArg;
+}
+
+static bool compareRecords(void* pItem, void* pComparisonArg) {
+    return ((TestRecord*)pItem)->value == *(int*)pComparisonArg;
+}
+
+// The record behind an IList link, for comparing against what List returns
+static TestRecord* recordOf(IListLink* link) {
+    return ILIST_ENTRY(link, TestRecord, link);
+}
+
+void testIListMatchesList() {
+    printf("Testing IList against List...\n");
+    enum { NUM_RECORDS = 2000, NUM_OPS = 200000 };
+    static TestRecord records[NUM_RECORDS];
+    TestRecord* spare[NUM_RECORDS]; // Records in neither list
+    int numSpare = 0;
+    for (int i = 0; i < NUM_RECORDS; i++) {
+        records[i].value = i % 64;
+        spare[numSpare++] = &records[i];
+    }
+    List* list = List_create();
+    IList ilist;
+    IList_init(&ilist);
+    srand(4321);
+
+    for (int op = 0; op < NUM_OPS; op++) {
+        int choice = rand() % 14;
+        if (numSpare < 100 && choice >= 4 && choice <= 7) {
+            choice = 8 + choice % 2;
+        }
+        TestRecord* record = NULL;
+        if (choice >= 4 && choice <= 7) {
+            record = spare[--numSpare];
+        }
+        switch (choice) {
+        case 0: assert(List_first(list) == recordOf(IList_first(&ilist))); break;
+        case 1: assert(List_last(list) == recordOf(IList_last(&ilist))); break;
+        case 2: assert(List_next(list) == recordOf(IList_next(&ilist))); break;
+        case 3: assert(List_prev(list) == recordOf(IList_prev(&ilist))); break;
+        case 4: List_insert_after(list, record); IList_insert_after(&ilist, &record->link); break;
+        case 5: List_insert_before(list, record); IList_insert_before(&ilist, &record->link); break;
+        case 6: List_append(list, record); IList_append(&ilist, &record->link); break;
+        case 7: List_prepend(list, record); IList_prepend(&ilist, &record->link); break;
+        case 8:
+        case 9: {
+            TestRecord* removed = choice == 8 ? List_remove(list) : List_trim(list);
+            IListLink* link = choice == 8 ? IList_remove(&ilist) : IList_trim(&ilist);
+            assert(removed == recordOf(link));
+            if (removed != NULL) {
+                assert(link->next == NULL && link->prev == NULL);
+                spare[numSpare++] = removed;
+            }
+            break;
+        }
+        case 10: {
+            int value = rand() % 64;
+            assert(List_search(list, compareRecords, &value) == recordOf(IList_search(&ilist, compareRecordLinks, &value)));
+            break;
+        }
+        case 11: {
+            // Concatenate a short run of records onto both
+            List* list2 = List_create();
+            IList ilist2;
+            IList_init(&ilist2);
+            for (int i = rand() % 20; i > 0 && numSpare > 0; i--) {
+                record = spare[--numSpare];
+                List_append(list2, record);
+                IList_append(&ilist2, &record->link);
+            }
+            List_concat(list, list2);
+            IList_concat(&ilist, &ilist2);
+            assert(IList_count(&ilist2) == 0 && IList_first(&ilist2) == NULL);
+            break;
+        }
+        default:
+            if (list->curr != NULL) {
+                assert(List_curr(list) == recordOf(IList_curr(&ilist)));
+            }
+            break;
+        }
+        assert(List_count(list) == IList_count(&ilist));
+    }
+
+    // Same contents in the same order
+    void* item = List_first(list);
+    IListLink* link = IList_first(&ilist);
+    while (item != NULL || link != NULL) {
+        assert(item == recordOf(link));
+        item = List_next(list);
+        link = IList_next(&ilist);
+    }
+
+    freedCount = 0;
+    int count = IList_count(&ilist);
+    IList_clear(&ilist, countingFree);
+    assert(freedCount == count && IList_count(&ilist) == 0 && IList_first(&ilist) == NULL);
+    List_free(list, NULL);
+    printf("IList against List: Passed\n\n");
+}
+
+// Counts the places where pList's next node is not in the slot right after the one before
+// it, given the stride of its arena's nodes
+static int countLayoutBreaks(List* pList, size_t stride) {
+    int breaks = 0;
+    char* previous = NULL;
+    for (void* item = List_first(pList); item != NULL; item = List_next(pList)) {
+        char* node = (char*)pList->curr;
+        if (previous != NULL && node != previous + stride) {
+            breaks++;
+        }
+        previous = node;
+    }
+    return breaks;
+}
+
+// Scatters pList's nodes over the pool by taking out and putting back random items
+static void churnList(List* pList, int rounds) {
+    for (int r = 0; r < rounds; r++) {
+        void* item = List_seek(pList, rand() % List_count(pList));
+        List_remove(pList);
+        List_seek(pList, rand() % List_count(pList));
+        assert(List_insert_after(pList, item) == LIST_SUCCESS);
+    }
+}
+
+static int compareIntValues(const void* pItem1, const void* pItem2) {
+    int a = *(const int*)pItem1;
+    int b = *(const int*)pItem2;
+    return (a > b) - (a < b);
+}
+
+// Frees count nodes of arena's (the default arena's if arena is NULL) that were taken
+// after every node in use now, which a compaction in steps can lay a list out in. The
+// default pool's released slots (and up to a magazine's worth cached by this thread) go
+// to a filler list freed first, so the fresh ones are the next the depot hands out.
+static void makeRoom(ListArena* arena, int count) {
+    List* filler = arena != NULL ? List_create_in(arena) : List_create();
+    List* spare = arena != NULL ? List_create_in(arena) : List_create();
+    int numFree = 0;
+    if (arena == NULL) {
+        ListPoolStats stats;
+        List_get_pool_stats(&stats);
+        numFree = stats.nodeCapacity - stats.nodesReserved + 64;
+    }
+    for (int i = 0; i < numFree; i++) {
+        assert(List_append(filler, &count) == LIST_SUCCESS);
+    }
+    for (int i = 0; i < count; i++) {
+        assert(List_append(spare, &count) == LIST_SUCCESS);
+    }
+    List_free(filler, NULL);
+    List_free(spare, NULL);
+}
+
+// Checks pList holds items[0..count-1] in order, following the links both ways
+static void assertListItems(List* pList, int** items, int count) {
+    assert(List_count(pList) == count);
+    int i = 0;
+    for (int* item = List_first(pList); item != NULL; item = List_next(pList)) {
+        assert(item == items[i++]);
+    }
+    assert(i == count);
+    for (int* item = List_last(pList); item != NULL; item = List_prev(pList)) {
+        assert(item == items[--i]);
+    }
+    assert(i == 0);
+}
+
+void testListCompact() {
+    printf("Testing List_compact...\n");
+    enum { NUM_VALUES = 10000 };
+    static int values[NUM_VALUES];
+    static int* items[NUM_VALUES];
+    for (int i = 0; i < NUM_VALUES; i++) {
+        values[i] = i;
+    }
+    srand(97531);
+
+    List* myList = List_create();
+    for (int i = 0; i < NUM_VALUES; i++) {
+        assert(List_append(myList, &values[i]) == LIST_SUCCESS);
+    }
+    assert(List_enable_index(myList, hashInt, compareInts) == 0);
+    churnList(myList, 4 * NUM_VALUES);
+    int count = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        items[count++] = item;
+    }
+    assert(countLayoutBreaks(myList, sizeof(Node)) > NUM_VALUES / 2);
+
+    // The nodes end up in runs of consecutive slots, one break per slab at most,
+    // with the items, the current item and the index as they were
+    ListPoolStats before, after;
+    List_get_pool_stats(&before);
+    List_seek(myList, 1234);
+    assert(List_compact(myList) == LIST_SUCCESS);
+    assert(List_curr(myList) == items[1234]);
+    assert(List_index_of_curr(myList) == 1234);
+    assert(countLayoutBreaks(myList, sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2);
+    assertListItems(myList, items, count);
+    for (int i = 0; i < NUM_VALUES; i++) {
+        assert(List_find_key(myList, &values[i]) == &values[i]);
+    }
+    List_get_pool_stats(&after);
+    assert(after.nodesInUse == before.nodesInUse);
+
+    // A compact list stays where it is
+    Node* head = myList->head;
+    assert(List_compact(myList) == LIST_SUCCESS);
+    assert(myList->head == head);
+
+    // In steps, with items taken out and put in between them
+    churnList(myList, 4 * NUM_VALUES);
+    makeRoom(NULL, NUM_VALUES);
+    ListCompactor compactor;
+    ListCompactor_init(&compactor, myList);
+    int steps = 0;
+    int result;
+    while ((result = ListCompactor_step(&compactor, 500)) == 1) {
+        steps++;
+        if (steps == 3 || steps == 10) {
+            churnList(myList, 1); // Starts the compaction over
+        }
+        assert(steps < 100);
+    }
+    assert(result == 0);
+    // Each start over can leave the item put in, and the step after it, out of line
+    assert(countLayoutBreaks(myList, sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2 + 2 * 2);
+    count = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        items[count++] = item;
+    }
+    assert(count == NUM_VALUES);
+    assertListItems(myList, items, count);
+    for (int i = 0; i < NUM_VALUES; i++) {
+        assert(List_find_key(myList, &values[i]) == &values[i]);
+    }
+
+    // A sort between steps moves the node the last one ended at, so the next starts over
+    churnList(myList, 4 * NUM_VALUES);
+    makeRoom(NULL, 2 * NUM_VALUES); // The first step takes up half of it
+    ListCompactor_init(&compactor, myList);
+    assert(ListCompactor_step(&compactor, NUM_VALUES / 2) == 1);
+    assert(List_sort(myList, compareIntValues) == LIST_SUCCESS);
+    while ((result = ListCompactor_step(&compactor, 500)) == 1) {
+    }
+    assert(result == 0);
+    assert(countLayoutBreaks(myList, sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2);
+    count = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        assert(item == &values[count]);
+        items[count++] = item;
+    }
+
+    // However often the list is churned and compacted again, the pool does not grow
+    List_get_pool_stats(&before);
+    for (int cycle = 0; cycle < 5; cycle++) {
+        churnList(myList, NUM_VALUES / 10);
+        assert(List_compact(myList) == LIST_SUCCESS);
+        churnList(myList, NUM_VALUES / 10);
+        ListCompactor_init(&compactor, myList);
+        while ((result = ListCompactor_step(&compactor, 500)) == 1) {
+        }
+        assert(result == 0);
+        List_get_pool_stats(&after);
+        assert(after.nodeCapacity == before.nodeCapacity);
+        assert(after.nodesInUse == before.nodesInUse);
+    }
+    assert(List_compact(myList) == LIST_SUCCESS);
+    assert(countLayoutBreaks(myList, sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2);
+    count = 0;
+    for (int* item = List_first(myList); item != NULL; item = List_next(myList)) {
+        items[count++] = item;
+    }
+    assert(count == NUM_VALUES);
+
+    // Every list in an arena at once
+    ListArena* arena = ListArena_create();
+    List* lists[3];
+    for (int l = 0; l < 3; l++) {
+        lists[l] = List_create_in(arena);
+    }
+    for (int i = 0; i < NUM_VALUES; i++) {
+        assert(List_append(lists[i % 3], &values[i]) == LIST_SUCCESS);
+    }
+    List_free(List_create_in(arena), NULL); // A released head is not a list
+    makeRoom(arena, NUM_VALUES);
+    assert(countLayoutBreaks(lists[0], sizeof(Node)) > NUM_VALUES / 4);
+    assert(ListArena_compact(arena) == 3);
+    for (int l = 0; l < 3; l++) {
+        assert(countLayoutBreaks(lists[l], sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2);
+        int i = l;
+        for (int* item = List_first(lists[l]); item != NULL; item = List_next(lists[l])) {
+            assert(item == &values[i]);
+            i += 3;
+        }
+    }
+    ListArena_destroy(arena);
+
+    // In steps, with lists freed and made between them
+    arena = ListArena_create();
+    List* stepped[4];
+    for (int l = 0; l < 4; l++) {
+        stepped[l] = List_create_in(arena);
+    }
+    for (int i = 0; i < NUM_VALUES; i++) {
+        assert(List_append(stepped[i % 4], &values[i]) == LIST_SUCCESS);
+    }
+    makeRoom(arena, 2 * NUM_VALUES);
+    ListArenaCompactor arenaCompactor;
+    ListArenaCompactor_init(&arenaCompactor, arena);
+    steps = 0;
+    while ((result = ListArenaCompactor_step(&arenaCompactor, 500)) == 1) {
+        steps++;
+        if (steps == 2) {
+            // The list being compacted goes, and a new list takes its head
+            assert(arenaCompactor.list.pList == stepped[0]);
+            List_free(stepped[0], NULL);
+            stepped[0] = List_create_in(arena);
+            assert(arenaCompactor.list.pList == stepped[0]);
+            assert(stepped[0]->generation > arenaCompactor.list.generation); // So it starts over
+            for (int i = 0; i < NUM_VALUES; i += 4) {
+                assert(List_append(stepped[0], &values[i]) == LIST_SUCCESS);
+            }
+        }
+        if (steps == 3) {
+            List_free(stepped[3], NULL); // One not reached yet
+        }
+        assert(steps < 100);
+    }
+    assert(result == 0);
+    assert(arenaCompactor.compacted == 3);
+    // The steps after stepped[0] started over took the lone slots stepped[3] gave back
+    // first, which leave its nodes no further apart than in pairs
+    assert(countLayoutBreaks(stepped[0], sizeof(Node)) <= NUM_VALUES / 4 / 2);
+    for (int l = 0; l < 3; l++) {
+        if (l > 0) {
+            assert(countLayoutBreaks(stepped[l], sizeof(Node)) <= NUM_VALUES / POOL_SLAB_SIZE + 2);
+        }
+        int i = l;
+        for (int* item = List_first(stepped[l]); item != NULL; item = List_next(stepped[l])) {
+            assert(item == &values[i]);
+            i += 4;
+        }
+        assert(i - 4 < NUM_VALUES && i >= NUM_VALUES);
+    }
+    ListArena_destroy(arena);
+    assert(ListArena_compact(NULL) >= 1);
+    assertListItems(myList, items, count);
+
+    // RCU readers could still be on the old nodes
+    assert(List_enable_rcu(myList) == 0);
+    assert(List_compact(myList) == LIST_FAIL);
+    List_free(myList, NULL);
+
+    // Inline items move with their nodes
+    ListArena* inlineArena = ListArena_create_inline(sizeof(Sample));
+#ifndef LIST_COMPACT_LINKS
+    List* samples = List_create_in(inlineArena);
+    assert(List_enable_index(samples, hashSampleId, compareSampleIds) == 0);
+    for (int i = 0; i < 1000; i++) {
+        Sample sample = { i, 1000 + i };
+        assert(List_append_copy(samples, &sample) == LIST_SUCCESS);
+    }
+    for (int r = 0; r < 2000; r++) {
+        Sample sample;
+        List_seek(samples, rand() % List_count(samples));
+        assert(List_remove_copy(samples, &sample) == 0);
+        List_seek(samples, rand() % List_count(samples));
+        assert(List_insert_after_copy(samples, &sample) == LIST_SUCCESS);
+    }
+    int64_t ids[1000];
+    int numSamples = 0;
+    for (Sample* sample = List_first(samples); sample != NULL; sample = List_next(samples)) {
+        ids[numSamples++] = sample->id;
+    }
+    size_t stride = sizeof(Node) + sizeof(Sample); // Sample needs no padding
+    assert(countLayoutBreaks(samples, stride) > numSamples / 2);
+    assert(List_compact(samples) == LIST_SUCCESS);
+    assert(countLayoutBreaks(samples, stride) <= 2);
+    int i = 0;
+    for (Sample* sample = List_first(samples); sample != NULL; sample = List_next(samples)) {
+        assert(sample->id == ids[i] && sample->timestamp == 1000 + ids[i]);
+        assert((char*)sample == (char*)samples->curr + sizeof(Node));
+        Sample key = { ids[i], 0 };
+        assert(List_find_key(samples, &key) == sample);
+        i++;
+    }
+    assert(i == numSamples);
+    ListArena_destroy(inlineArena);
+#else
+    assert(inlineArena == NULL);
+#endif
+    printf("List_compact: Passed\n\n");
+}
 
 int main() {
     testListCreate();
@@ -193,8 +2370,33 @@ int main() {
     testListInsertAfterAndBefore();
     testListRemove();
     testListTrim();
+    testListMoveToFront();
     testListConcat();
     testListSearch();
+    testListSearchBatch();
+    testListSort();
+    testListCompact();
+    testListBulkInsert();
+    testListFreeWholeChain();
+    testListSeek();
+    testListIter();
+    testListIterThreads();
+    testListRcu();
+    testListIndex();
+    testListArena();
+    testListInline();
+    testListTyped();
+    testListSnapshot();
+    testListPersistentArena();
+    testListPoolGrowth();
+    testListThreads();
+    testListStats();
+    testListLru();
+    testListQueue();
+    testListQueueThreads();
+    testUListMatchesList();
+    testListDequeMatchesList();
+    testIListMatchesList();
 
     printf("All tests passed successfully!\n");
     return 0;
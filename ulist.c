@@ -0,0 +1,444 @@
+#include "ulist.h"
+#include "pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+
+// Pools for chunks and list heads, shared by all threads behind one lock.
+// A chunk is allocated once per ULIST_CHUNK_ITEMS inserts at most, so the lock is cheap.
+static Pool chunkPool;
+static Pool ulistPool;
+static pthread_mutex_t ulistPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t ulistPoolsInitialized = PTHREAD_ONCE_INIT;
+
+static void initializeUListPools() {
+    Pool_init(&chunkPool, sizeof(UListChunk));
+    Pool_init(&ulistPool, sizeof(UList));
+}
+
+static UListChunk* allocateChunk() {
+    pthread_mutex_lock(&ulistPoolLock);
+    int chunkIndex = Pool_alloc(&chunkPool);
+    pthread_mutex_unlock(&ulistPoolLock);
+    if (chunkIndex < 0) {
+        return NULL;
+    }
+    UListChunk* chunk = Pool_at(&chunkPool, chunkIndex);
+    chunk->next = NULL;
+    chunk->prev = NULL;
+    chunk->count = 0;
+    return chunk;
+}
+
+static void freeChunk(UListChunk* chunk) {
+    pthread_mutex_lock(&ulistPoolLock);
+    Pool_free(&chunkPool, Pool_indexOf(&chunkPool, chunk));
+    pthread_mutex_unlock(&ulistPoolLock);
+}
+
+// Links chunk into pList after the given chunk, or at the front if after is NULL
+static void linkChunkAfter(UList* pList, UListChunk* after, UListChunk* chunk) {
+    chunk->prev = after;
+    chunk->next = after != NULL ? after->next : pList->head;
+    if (chunk->next != NULL) {
+        chunk->next->prev = chunk;
+    } else {
+        pList->tail = chunk;
+    }
+    if (after != NULL) {
+        after->next = chunk;
+    } else {
+        pList->head = chunk;
+    }
+}
+
+static void unlinkChunk(UList* pList, UListChunk* chunk) {
+    if (chunk->prev != NULL) {
+        chunk->prev->next = chunk->next;
+    } else {
+        pList->head = chunk->next;
+    }
+    if (chunk->next != NULL) {
+        chunk->next->prev = chunk->prev;
+    } else {
+        pList->tail = chunk->prev;
+    }
+}
+
+// Inserts pItem at position slot (0..count) of chunk, or into an empty list when
+// chunk is NULL, and makes it the current item. Returns 0 on success, -1 on failure.
+static int insertAt(UList* pList, UListChunk* chunk, int slot, void* pItem) {
+    if (chunk == NULL) {
+        chunk = allocateChunk();
+        if (chunk == NULL) {
+            return -1;
+        }
+        linkChunkAfter(pList, NULL, chunk);
+        slot = 0;
+    }
+    else if (chunk->count == ULIST_CHUNK_ITEMS) {
+        if (slot == ULIST_CHUNK_ITEMS && chunk->next != NULL && chunk->next->count < ULIST_CHUNK_ITEMS) {
+            // Past the end of a full chunk: spill into the front of the next one
+            chunk = chunk->next;
+            slot = 0;
+        }
+        else if (slot == 0 && chunk->prev != NULL && chunk->prev->count < ULIST_CHUNK_ITEMS) {
+            // Before the start of a full chunk: spill onto the end of the previous one
+            chunk = chunk->prev;
+            slot = chunk->count;
+        }
+        else {
+            UListChunk* newChunk = allocateChunk();
+            if (newChunk == NULL) {
+                return -1;
+            }
+            if (slot == ULIST_CHUNK_ITEMS) {
+                // Appending keeps chunks full rather than splitting them
+                linkChunkAfter(pList, chunk, newChunk);
+                chunk = newChunk;
+                slot = 0;
+            }
+            else if (slot == 0) {
+                linkChunkAfter(pList, chunk->prev, newChunk);
+                chunk = newChunk;
+            }
+            else {
+                // Split: the upper half moves to a new chunk after this one
+                int keep = (ULIST_CHUNK_ITEMS + 1) / 2;
+                linkChunkAfter(pList, chunk, newChunk);
+                newChunk->count = ULIST_CHUNK_ITEMS - keep;
+                memcpy(newChunk->items, &chunk->items[keep], newChunk->count * sizeof(void*));
+                chunk->count = keep;
+                if (slot > keep) {
+                    chunk = newChunk;
+                    slot -= keep;
+                }
+            }
+        }
+    }
+
+    memmove(&chunk->items[slot + 1], &chunk->items[slot], (chunk->count - slot) * sizeof(void*));
+    chunk->items[slot] = pItem;
+    chunk->count++;
+    pList->size++;
+    pList->currChunk = chunk;
+    pList->currSlot = slot;
+    return 0;
+}
+
+// Called after an item is taken out of chunk. Frees the chunk if it is empty, or
+// merges it with a neighbour if it is less than half full and they fit in one chunk.
+// (*pChunk, *pSlot) is a position in the list that is updated to follow its item.
+static void rebalance(UList* pList, UListChunk* chunk, UListChunk** pChunk, int* pSlot) {
+    if (chunk->count == 0) {
+        unlinkChunk(pList, chunk);
+        freeChunk(chunk);
+        return;
+    }
+    if (chunk->count * 2 >= ULIST_CHUNK_ITEMS) {
+        return;
+    }
+
+    UListChunk* next = chunk->next;
+    UListChunk* prev = chunk->prev;
+    if (next != NULL && chunk->count + next->count <= ULIST_CHUNK_ITEMS) {
+        // Pull the next chunk's items onto the end of this one
+        memcpy(&chunk->items[chunk->count], next->items, next->count * sizeof(void*));
+        if (*pChunk == next) {
+            *pChunk = chunk;
+            *pSlot += chunk->count;
+        }
+        chunk->count += next->count;
+        unlinkChunk(pList, next);
+        freeChunk(next);
+    }
+    else if (prev != NULL && prev->count + chunk->count <= ULIST_CHUNK_ITEMS) {
+        // Push this chunk's items onto the end of the previous one
+        memcpy(&prev->items[prev->count], chunk->items, chunk->count * sizeof(void*));
+        if (*pChunk == chunk) {
+            *pChunk = prev;
+            *pSlot += prev->count;
+        }
+        prev->count += chunk->count;
+        unlinkChunk(pList, chunk);
+        freeChunk(chunk);
+    }
+}
+
+//######################################################################################################################
+//######################################################################################################################
+
+// Makes a new, empty list, and returns its reference on success.
+// Returns a NULL pointer on failure.
+UList* UList_create() {
+    pthread_once(&ulistPoolsInitialized, initializeUListPools);
+
+    pthread_mutex_lock(&ulistPoolLock);
+    int listIndex = Pool_alloc(&ulistPool);
+    pthread_mutex_unlock(&ulistPoolLock);
+    if (listIndex < 0) {
+        return NULL;
+    }
+
+    UList* pList = Pool_at(&ulistPool, listIndex);
+    memset(pList, 0, sizeof(UList));
+    return pList;
+}
+
+// Returns the number of items in pList.
+int UList_count(UList* pList) {
+    return pList->size;
+}
+
+// Returns a pointer to the first item in pList and makes the first item the current item.
+void* UList_first(UList* pList) {
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->currChunk = pList->head;
+    pList->currSlot = 0;
+    if (pList->currChunk == NULL) {
+        return NULL;
+    }
+    return pList->currChunk->items[0];
+}
+
+// Returns a pointer to the last item in pList and makes the last item the current item.
+void* UList_last(UList* pList) {
+    assert(pList != NULL);
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+    pList->currChunk = pList->tail;
+    if (pList->currChunk == NULL) {
+        return NULL;
+    }
+    pList->currSlot = pList->currChunk->count - 1;
+    return pList->currChunk->items[pList->currSlot];
+}
+
+// Advances pList's current item by one, and returns a pointer to the new current item.
+void* UList_next(UList* pList) {
+    assert(pList != NULL);
+
+    if (pList->currChunk == NULL || pList->oob_end) {
+        pList->oob_end = true;
+        return NULL;
+    }
+
+    if (pList->currSlot + 1 < pList->currChunk->count) {
+        pList->currSlot++;
+    }
+    else {
+        pList->currChunk = pList->currChunk->next;
+        pList->currSlot = 0;
+        if (pList->currChunk == NULL) {
+            pList->oob_end = true;
+            return NULL;
+        }
+    }
+
+    pList->oob_end = false;
+    return pList->currChunk->items[pList->currSlot];
+}
+
+// Backs up pList's current item by one, and returns a pointer to the new current item.
+void* UList_prev(UList* pList) {
+    assert(pList != NULL);
+
+    if (pList->currChunk == NULL || pList->oob_start) {
+        pList->oob_start = true;
+        return NULL;
+    }
+
+    if (pList->currSlot > 0) {
+        pList->currSlot--;
+    }
+    else {
+        pList->currChunk = pList->currChunk->prev;
+        if (pList->currChunk == NULL) {
+            pList->oob_start = true;
+            return NULL;
+        }
+        pList->currSlot = pList->currChunk->count - 1;
+    }
+
+    pList->oob_start = false;
+    return pList->currChunk->items[pList->currSlot];
+}
+
+// Returns a pointer to the current item in pList, or NULL if there is none.
+void* UList_curr(UList* pList) {
+    assert(pList != NULL);
+
+    if (pList->currChunk == NULL) {
+        return NULL;
+    }
+    return pList->currChunk->items[pList->currSlot];
+}
+
+// Adds the new item to pList directly after the current item, and makes item the current item.
+int UList_insert_after(UList* pList, void* pItem) {
+    assert(pList != NULL);
+
+    if (pList->head == NULL) {
+        return insertAt(pList, NULL, 0, pItem);
+    }
+    // If curr is beyond the end, add to the end.
+    if (pList->currChunk == NULL || pList->oob_end) {
+        return insertAt(pList, pList->tail, pList->tail->count, pItem);
+    }
+    return insertAt(pList, pList->currChunk, pList->currSlot + 1, pItem);
+}
+
+// Adds item to pList directly before the current item, and makes the new item the current one.
+int UList_insert_before(UList* pList, void* pItem) {
+    assert(pList != NULL);
+
+    if (pList->head == NULL) {
+        return insertAt(pList, NULL, 0, pItem);
+    }
+    // If curr is before the start, add to start.
+    if (pList->currChunk == NULL || pList->oob_start) {
+        return insertAt(pList, pList->head, 0, pItem);
+    }
+    return insertAt(pList, pList->currChunk, pList->currSlot, pItem);
+}
+
+// Adds item to the end of pList, and makes the new item the current one.
+int UList_append(UList* pList, void* pItem) {
+    assert(pList != NULL);
+
+    if (pList->tail == NULL) {
+        return insertAt(pList, NULL, 0, pItem);
+    }
+    return insertAt(pList, pList->tail, pList->tail->count, pItem);
+}
+
+// Adds item to the front of pList, and makes the new item the current one.
+int UList_prepend(UList* pList, void* pItem) {
+    assert(pList != NULL);
+
+    return insertAt(pList, pList->head, 0, pItem);
+}
+
+// Return current item and take it out of pList. Make the next item the current one.
+void* UList_remove(UList* pList) {
+    assert(pList != NULL);
+
+    UListChunk* chunk = pList->currChunk;
+    if (chunk == NULL) {
+        return NULL;
+    }
+    int slot = pList->currSlot;
+    void* item = chunk->items[slot];
+
+    chunk->count--;
+    memmove(&chunk->items[slot], &chunk->items[slot + 1], (chunk->count - slot) * sizeof(void*));
+    pList->size--;
+
+    // The next item slides into the removed slot, or starts the next chunk
+    if (slot == chunk->count) {
+        pList->currChunk = chunk->next;
+        pList->currSlot = 0;
+    }
+    rebalance(pList, chunk, &pList->currChunk, &pList->currSlot);
+    return item;
+}
+
+// Return last item and take it out of pList. Make the new last item the current one.
+void* UList_trim(UList* pList) {
+    assert(pList != NULL);
+
+    UListChunk* chunk = pList->tail;
+    if (chunk == NULL) {
+        return NULL;
+    }
+    bool wasCurrent = pList->currChunk == chunk && pList->currSlot == chunk->count - 1;
+    void* item = chunk->items[--chunk->count];
+    pList->size--;
+
+    if (wasCurrent) {
+        if (chunk->count > 0) {
+            pList->currSlot = chunk->count - 1;
+        }
+        else {
+            pList->currChunk = chunk->prev;
+            pList->currSlot = chunk->prev != NULL ? chunk->prev->count - 1 : 0;
+        }
+    }
+    rebalance(pList, chunk, &pList->currChunk, &pList->currSlot);
+    return item;
+}
+
+// Adds pList2 to the end of pList1. pList2 no longer exists after the operation.
+void UList_concat(UList* pList1, UList* pList2) {
+    assert(pList1 != NULL && pList2 != NULL);
+
+    if (pList2->head != NULL) {
+        if (pList1->tail != NULL) {
+            pList1->tail->next = pList2->head;
+            pList2->head->prev = pList1->tail;
+        }
+        else {
+            pList1->head = pList2->head;
+        }
+        pList1->tail = pList2->tail;
+        pList1->size += pList2->size;
+    }
+
+    pthread_mutex_lock(&ulistPoolLock);
+    Pool_free(&ulistPool, Pool_indexOf(&ulistPool, pList2));
+    pthread_mutex_unlock(&ulistPoolLock);
+}
+
+// Delete pList, invoking pItemFreeFn on each item.
+void UList_free(UList* pList, FREE_FN pItemFreeFn) {
+    assert(pList != NULL);
+
+    UListChunk* chunk = pList->head;
+    while (chunk != NULL) {
+        UListChunk* next = chunk->next;
+        for (int i = 0; pItemFreeFn != NULL && i < chunk->count; i++) {
+            pItemFreeFn(chunk->items[i]);
+        }
+        freeChunk(chunk);
+        chunk = next;
+    }
+
+    pthread_mutex_lock(&ulistPoolLock);
+    Pool_free(&ulistPool, Pool_indexOf(&ulistPool, pList));
+    pthread_mutex_unlock(&ulistPoolLock);
+}
+
+// Search pList, starting at the current item, until the end is reached or a match is found.
+void* UList_search(UList* pList, COMPARATOR_FN pComparator, void* pComparisonArg) {
+    assert(pList != NULL && pComparator != NULL);
+
+    UListChunk* chunk = pList->currChunk;
+    int slot = pList->currSlot;
+
+    pList->oob_start = false;
+    pList->oob_end = false;
+
+    // If the current pointer is before the start of the pList, start from the head
+    if (chunk == NULL) {
+        chunk = pList->head;
+        slot = 0;
+    }
+
+    for (; chunk != NULL; chunk = chunk->next, slot = 0) {
+        for (; slot < chunk->count; slot++) {
+            if (pComparator(chunk->items[slot], pComparisonArg)) {
+                pList->currChunk = chunk;
+                pList->currSlot = slot;
+                return chunk->items[slot];
+            }
+        }
+    }
+
+    pList->oob_end = true;
+    pList->currChunk = NULL;
+    return NULL;
+}
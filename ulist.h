@@ -0,0 +1,88 @@
+// Unrolled list: the same interface and cursor semantics as List, but each
+// chunk holds up to ULIST_CHUNK_ITEMS item pointers in an array, so walks and
+// searches touch one chunk per ULIST_CHUNK_ITEMS items instead of one node per item.
+
+#ifndef _ULIST_H_
+#define _ULIST_H_
+#include "list.h"
+
+// Items per chunk; a chunk (two links, a count and the items) fills two cache lines
+#define ULIST_CHUNK_ITEMS 13
+
+typedef struct UListChunk_s UListChunk;
+struct UListChunk_s {
+    UListChunk* next;
+    UListChunk* prev;
+    int count;
+    void* items[ULIST_CHUNK_ITEMS];
+};
+
+typedef struct UList_s UList;
+struct UList_s {
+    UListChunk* head;
+    UListChunk* tail;
+    UListChunk* currChunk; // NULL when there is no current item
+    int currSlot;          // Index of the current item within currChunk
+    int size;
+    bool oob_start;  // Flag for out-of-bounds at the start
+    bool oob_end;    // Flag for out-of-bounds at the end
+};
+
+// Each function below behaves exactly like its List_ counterpart in list.h,
+// including where the current item ends up.
+
+// Makes a new, empty list, and returns its reference on success.
+// Returns a NULL pointer on failure.
+UList* UList_create();
+
+// Returns the number of items in pList.
+int UList_count(UList* pList);
+
+// Returns a pointer to the first item in pList and makes the first item the current item.
+void* UList_first(UList* pList);
+
+// Returns a pointer to the last item in pList and makes the last item the current item.
+void* UList_last(UList* pList);
+
+// Advances pList's current item by one, and returns a pointer to the new current item.
+void* UList_next(UList* pList);
+
+// Backs up pList's current item by one, and returns a pointer to the new current item.
+void* UList_prev(UList* pList);
+
+// Returns a pointer to the current item in pList, or NULL if there is none.
+void* UList_curr(UList* pList);
+
+// Adds the new item to pList directly after the current item, and makes item the current item.
+// A full chunk is split in two. Returns 0 on success, -1 on failure.
+int UList_insert_after(UList* pList, void* pItem);
+
+// Adds item to pList directly before the current item, and makes the new item the current one.
+// A full chunk is split in two. Returns 0 on success, -1 on failure.
+int UList_insert_before(UList* pList, void* pItem);
+
+// Adds item to the end of pList, and makes the new item the current one.
+// Returns 0 on success, -1 on failure.
+int UList_append(UList* pList, void* pItem);
+
+// Adds item to the front of pList, and makes the new item the current one.
+// Returns 0 on success, -1 on failure.
+int UList_prepend(UList* pList, void* pItem);
+
+// Return current item and take it out of pList. Make the next item the current one.
+// A chunk left less than half full is merged with a neighbour when they fit in one chunk.
+void* UList_remove(UList* pList);
+
+// Return last item and take it out of pList. Make the new last item the current one.
+void* UList_trim(UList* pList);
+
+// Adds pList2 to the end of pList1. pList2 no longer exists after the operation.
+void UList_concat(UList* pList1, UList* pList2);
+
+// Delete pList, invoking pItemFreeFn on each item (if pItemFreeFn is not NULL).
+void UList_free(UList* pList, FREE_FN pItemFreeFn);
+
+// Search pList, starting at the current item, until the end is reached or a match is found.
+void* UList_search(UList* pList, COMPARATOR_FN pComparator, void* pComparisonArg);
+
+#endif